@@ -0,0 +1,100 @@
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstddef>
+#include <numeric>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include <threadpool.hpp>
+#include <parallel.hpp>
+
+// Times every vsock::par algorithm against its sequential std:: counterpart.
+// Usage: par_bench [elements] [threads]
+
+using namespace vsock;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+    constexpr int ROUNDS{ 5 };
+
+    template<typename F>
+    double BestOf(F&& fn) {
+        double best{ 0 };
+        for (int round = 0; round < ROUNDS; ++round) {
+            const auto start = clock_type::now();
+            fn();
+            const double elapsed = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+            best = round == 0 ? elapsed : std::min(best, elapsed);
+        }
+        return best;
+    }
+
+    void Report(const std::string& name, const double sequential, const double parallel, const bool same) {
+        std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << sequential << " ms" << std::setw(10) << parallel << " ms"
+            << std::setw(8) << sequential / parallel << "x" << (same ? "" : "  MISMATCH") << '\n';
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t size = argc > 1 ? std::stoul(argv[1]) : std::size_t{ 1 } << 24;
+    const std::size_t threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    ThreadPool pool(threads);
+
+    std::mt19937_64 rng(42);
+    std::vector<double> input(size);
+    for (double& value : input) {
+        value = static_cast<double>(rng() % 1000000) / 1000.0;
+    }
+    std::vector<std::int64_t> integers(size);
+    for (std::int64_t& value : integers) {
+        value = static_cast<std::int64_t>(rng() % 1000);
+    }
+
+    std::cout << size << " elements, " << pool.ThreadsCount() << " threads, best of " << ROUNDS << "\n\n";
+    std::cout << std::left << std::setw(18) << "algorithm" << std::right << std::setw(13) << "std::"
+        << std::setw(13) << "vsock::par" << std::setw(9) << "speedup" << '\n';
+
+    {
+        std::vector<double> expected, actual;
+        const double sequential = BestOf([&] { expected = input; std::sort(expected.begin(), expected.end()); });
+        const double parallel = BestOf([&] { actual = input; par::Sort(pool, actual.begin(), actual.end()); });
+        Report("sort", sequential, parallel, expected == actual);
+    }
+    {
+        std::vector<std::int64_t> expected(size), actual(size);
+        const double sequential = BestOf([&] { std::inclusive_scan(integers.begin(), integers.end(), expected.begin()); });
+        const double parallel = BestOf([&] { par::InclusiveScan(pool, integers.begin(), integers.end(), actual.begin()); });
+        Report("inclusive_scan", sequential, parallel, expected == actual);
+    }
+    {
+        std::vector<std::int64_t> expected(size), actual(size);
+        const double sequential = BestOf([&] { std::exclusive_scan(integers.begin(), integers.end(), expected.begin(), std::int64_t{ 0 }); });
+        const double parallel = BestOf([&] { par::ExclusiveScan(pool, integers.begin(), integers.end(), actual.begin(), std::int64_t{ 0 }); });
+        Report("exclusive_scan", sequential, parallel, expected == actual);
+    }
+    {
+        const auto square = [](const std::int64_t value) { return value * value; };
+        std::int64_t expected{ 0 }, actual{ 0 };
+        const double sequential = BestOf([&] { expected = std::transform_reduce(integers.begin(), integers.end(), std::int64_t{ 0 }, std::plus<>{}, square); });
+        const double parallel = BestOf([&] { actual = par::TransformReduce(pool, integers.begin(), integers.end(), std::int64_t{ 0 }, std::plus<>{}, square); });
+        Report("transform_reduce", sequential, parallel, expected == actual);
+    }
+    {
+        double expected{ 0 }, actual{ 0 };
+        const double sequential = BestOf([&] { expected = std::transform_reduce(input.begin(), input.end(), input.begin(), 0.0); });
+        const double parallel = BestOf([&] { actual = par::TransformReduce(pool, input.begin(), input.end(), input.begin(), 0.0); });
+        // Floating point sums differ by association order; compare relatively.
+        Report("inner_product", sequential, parallel, std::abs(expected - actual) <= 1e-9 * std::abs(expected));
+    }
+    return 0;
+}
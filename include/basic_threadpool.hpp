@@ -0,0 +1,213 @@
+#ifndef INCLUDE_GUARD_BASIC_THREADPOOL_HPP
+#define INCLUDE_GUARD_BASIC_THREADPOOL_HPP
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <future>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include <task.hpp>
+#include <pool_policies.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BasicThreadPool class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<
+        typename QueuePolicy = DequeQueue,
+        typename WaitPolicy = CondVarWait,
+        typename AllocPolicy = HeapAlloc,
+        typename MetricsPolicy = NoMetrics,
+        typename DestroyPolicy = SmoothDestroy
+    >
+    class BasicThreadPool {
+    public:
+
+        BasicThreadPool(BasicThreadPool&&) = delete;
+        BasicThreadPool& operator=(BasicThreadPool&&) = delete;
+
+    public:
+
+        using task_ptr_t = typename AllocPolicy::pointer;
+        using queue_t = typename QueuePolicy::template Policy<task_ptr_t>;
+
+        BasicThreadPool();
+        BasicThreadPool(const std::size_t concurency);
+        ~BasicThreadPool();
+
+        void Wait();
+        void Pause() noexcept;
+        void Continue() noexcept;
+        void ClearTasks() noexcept;
+
+        template<typename F, typename...Args>
+        auto AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
+
+        template<typename F, typename...Args>
+        void AddAsyncTask(F&& job, Args&&... args);
+
+        const MetricsPolicy& Metrics() const noexcept;
+
+    private:
+
+        std::size_t threads_count_;
+        std::unique_ptr<std::thread[]> threads_;
+
+        [[no_unique_address]] AllocPolicy alloc_;
+        [[no_unique_address]] MetricsPolicy metrics_;
+        queue_t tasks_;
+
+        WaitPolicy tasks_wait_;
+        WaitPolicy done_wait_;
+
+        std::atomic<std::size_t> tasks_pending_;
+        std::atomic<std::size_t> tasks_running_;
+        std::atomic_bool working_;
+        std::atomic_bool paused_;
+
+        void Push_(task_ptr_t&& task);
+        void Process_();
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BasicThreadPool class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline BasicThreadPool<Q, W, A, M, D>::BasicThreadPool() :
+        BasicThreadPool(std::thread::hardware_concurrency())
+    {}
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline BasicThreadPool<Q, W, A, M, D>::BasicThreadPool(const std::size_t concurency) :
+        threads_count_{ concurency > 0 ? concurency : 1 },
+        threads_{ std::make_unique<std::thread[]>(threads_count_) },
+        alloc_{ },
+        metrics_{ },
+        tasks_{ },
+        tasks_wait_{ },
+        done_wait_{ },
+        tasks_pending_{ 0 },
+        tasks_running_{ 0 },
+        working_{ true },
+        paused_{ false }
+    {
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            threads_[index] = std::thread(&BasicThreadPool::Process_, this);
+        }
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline BasicThreadPool<Q, W, A, M, D>::~BasicThreadPool() {
+        D::OnDestroy(*this);
+        working_.store(false);
+        tasks_wait_.NotifyAll();
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            threads_[index].join();
+        }
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline void BasicThreadPool<Q, W, A, M, D>::Wait() {
+        done_wait_.Wait([this] {
+            return tasks_pending_.load() == 0 || (paused_.load() && tasks_running_.load() == 0);
+        });
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline void BasicThreadPool<Q, W, A, M, D>::Pause() noexcept {
+        paused_.store(true);
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline void BasicThreadPool<Q, W, A, M, D>::Continue() noexcept {
+        paused_.store(false);
+        tasks_wait_.NotifyAll();
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline void BasicThreadPool<Q, W, A, M, D>::ClearTasks() noexcept {
+        task_ptr_t task;
+        while (tasks_.TryPop(task)) {
+            task.reset();
+            tasks_pending_.fetch_sub(1);
+        }
+        done_wait_.NotifyAll();
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    template<typename F, typename...Args>
+    inline auto BasicThreadPool<Q, W, A, M, D>::AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        task_ptr_t task_ptr(alloc_.Make());
+        auto result = task_ptr->SetSyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        Push_(std::move(task_ptr));
+        return result;
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    template<typename F, typename...Args>
+    inline void BasicThreadPool<Q, W, A, M, D>::AddAsyncTask(F&& job, Args&&... args) {
+        task_ptr_t task_ptr(alloc_.Make());
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        Push_(std::move(task_ptr));
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline const M& BasicThreadPool<Q, W, A, M, D>::Metrics() const noexcept {
+        return metrics_;
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline void BasicThreadPool<Q, W, A, M, D>::Push_(task_ptr_t&& task) {
+        metrics_.OnSubmit();
+        tasks_pending_.fetch_add(1);
+        while (!tasks_.TryPush(std::move(task))) {
+            std::this_thread::yield();
+        }
+        tasks_wait_.NotifyOne();
+    }
+
+    template<typename Q, typename W, typename A, typename M, typename D>
+    inline void BasicThreadPool<Q, W, A, M, D>::Process_() {
+        task_ptr_t task;
+        while (true) {
+            tasks_wait_.Wait([this] {
+                return !working_.load() || (!paused_.load() && !tasks_.Empty());
+            });
+            if (!working_.load()) {
+                break;
+            }
+
+            tasks_running_.fetch_add(1);
+            if (paused_.load() || !tasks_.TryPop(task)) {
+                tasks_running_.fetch_sub(1);
+                done_wait_.NotifyAll();
+                continue;
+            }
+
+            metrics_.OnStart();
+            const bool not_finished = (*task)();
+            metrics_.OnFinish();
+            if (not_finished) {
+                while (!tasks_.TryPush(std::move(task))) {
+                    std::this_thread::yield();
+                }
+            }
+            else {
+                task.reset();
+                tasks_pending_.fetch_sub(1);
+            }
+            tasks_running_.fetch_sub(1);
+            done_wait_.NotifyAll();
+        }
+    }
+
+}
+
+#endif // INCLUDE_GUARD_BASIC_THREADPOOL_HPP
@@ -0,0 +1,111 @@
+#include <budget.hpp>
+
+#include <thread>
+#include <algorithm>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ConcurrencyBudget class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ConcurrencyBudget::ConcurrencyBudget() :
+        ConcurrencyBudget(std::thread::hardware_concurrency())
+    {}
+
+    ConcurrencyBudget::ConcurrencyBudget(const std::size_t slots) :
+        slots_{ std::max<std::size_t>(slots, 1) },
+        mutex_{ },
+        slots_cv_{ },
+        members_{ },
+        active_{ 0 },
+        waiting_{ 0 }
+    {}
+
+    ConcurrencyBudget::~ConcurrencyBudget() = default;
+
+    std::size_t ConcurrencyBudget::Slots() const noexcept {
+        return slots_;
+    }
+
+    std::size_t ConcurrencyBudget::Active() const {
+        const std::scoped_lock budget_lock(mutex_);
+        return active_;
+    }
+
+    ConcurrencyBudget::Member& ConcurrencyBudget::Join_(const std::uint32_t weight) {
+        const std::scoped_lock budget_lock(mutex_);
+        return members_.emplace_back(Member{ std::max<std::uint32_t>(weight, 1), 0, 0, false });
+    }
+
+    void ConcurrencyBudget::Leave_(Member& member) noexcept {
+        const std::scoped_lock budget_lock(mutex_);
+        members_.remove_if([&member](const Member& candidate) { return &candidate == &member; });
+    }
+
+    bool ConcurrencyBudget::Acquire_(Member& member) {
+        std::unique_lock budget_lock(mutex_);
+        ++member.waiting;
+        waiting_.fetch_add(1, std::memory_order_relaxed);
+        slots_cv_.wait(budget_lock, [this, &member] {
+            return member.interrupted || (active_ < slots_ && Favoured_(member));
+        });
+        --member.waiting;
+        waiting_.fetch_sub(1, std::memory_order_relaxed);
+        if (member.interrupted) {
+            return false;
+        }
+        ++active_;
+        ++member.active;
+        return true;
+    }
+
+    void ConcurrencyBudget::Release_(Member& member) noexcept {
+        {
+            const std::scoped_lock budget_lock(mutex_);
+            --active_;
+            --member.active;
+        }
+        if (waiting_.load(std::memory_order_relaxed) > 0) {
+            slots_cv_.notify_all();
+        }
+    }
+
+    bool ConcurrencyBudget::Contended_(const Member& member) const noexcept {
+        if (waiting_.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+        const std::scoped_lock budget_lock(mutex_);
+        if (active_ < slots_ || member.active == 0) {
+            return false;
+        }
+        // Yield when another waiting pool would still be below this one's
+        // weighted share after taking over one of its slots.
+        for (const Member& other : members_) {
+            if (&other != &member && other.waiting > 0 &&
+                other.active * member.weight < (member.active - 1) * other.weight) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ConcurrencyBudget::Interrupt_(Member& member, const bool interrupted) noexcept {
+        {
+            const std::scoped_lock budget_lock(mutex_);
+            member.interrupted = interrupted;
+        }
+        slots_cv_.notify_all();
+    }
+
+    bool ConcurrencyBudget::Favoured_(const Member& member) const noexcept {
+        for (const Member& other : members_) {
+            if (&other != &member && other.waiting > 0 &&
+                other.active * member.weight < member.active * other.weight) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,69 @@
+#ifndef INCLUDE_GUARD_BUDGET_HPP
+#define INCLUDE_GUARD_BUDGET_HPP
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <condition_variable>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ConcurrencyBudget class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Process-wide cap on workers running at once across every ThreadPool that
+    // joins it (Config::budget). A worker holds a slot only while it has work,
+    // so idle pools lend their share to busy ones. Under contention a free slot
+    // goes to the waiting pool with the lowest active / weight ratio, and pools
+    // above their weighted share hand slots back between batches. The budget
+    // must outlive the pools that joined it.
+
+    class ConcurrencyBudget {
+    public:
+
+        ConcurrencyBudget(const ConcurrencyBudget&) = delete;
+        ConcurrencyBudget& operator=(const ConcurrencyBudget&) = delete;
+
+    public:
+
+        ConcurrencyBudget();
+        explicit ConcurrencyBudget(const std::size_t slots);
+        ~ConcurrencyBudget();
+
+        std::size_t Slots() const noexcept;
+        std::size_t Active() const;
+
+    private:
+
+        friend class ThreadPool;
+
+        struct Member {
+            std::uint32_t weight;
+            std::size_t active;
+            std::size_t waiting;
+            bool interrupted;
+        };
+
+        const std::size_t slots_;
+        mutable std::mutex mutex_;
+        std::condition_variable slots_cv_;
+        std::list<Member> members_;
+        std::size_t active_;
+        std::atomic<std::size_t> waiting_;
+
+        Member& Join_(const std::uint32_t weight);
+        void Leave_(Member& member) noexcept;
+        [[nodiscard]] bool Acquire_(Member& member);
+        void Release_(Member& member) noexcept;
+        [[nodiscard]] bool Contended_(const Member& member) const noexcept;
+        void Interrupt_(Member& member, const bool interrupted) noexcept;
+        [[nodiscard]] bool Favoured_(const Member& member) const noexcept;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_BUDGET_HPP
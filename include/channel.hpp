@@ -0,0 +1,408 @@
+#ifndef INCLUDE_GUARD_CHANNEL_HPP
+#define INCLUDE_GUARD_CHANNEL_HPP
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+#include <job.hpp>
+#include <spsc.hpp>
+#include <threadpool.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Channel class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Typed MPMC channel whose consumers run on a ThreadPool. Values pass
+    // through a lock-free ring; an unbounded channel spills into a locked
+    // overflow queue while the ring is full. Receive() never blocks a worker:
+    // with nothing to take, the continuation is parked and queued into the pool
+    // once a value arrives, or with std::nullopt once the channel is closed and
+    // drained. The channel must outlive its parked continuations.
+
+    template<typename T>
+    class Channel {
+    public:
+
+        Channel(const Channel&) = delete;
+        Channel& operator=(const Channel&) = delete;
+
+    public:
+
+        static constexpr std::size_t UNBOUNDED{ 0 };
+        static constexpr std::size_t DEFAULT_BATCH_SIZE{ 64 };
+
+        explicit Channel(ThreadPool& pool, const std::size_t capacity = UNBOUNDED);
+        ~Channel() = default;
+
+        bool TrySend(T value);
+        bool Send(T value);
+        bool TryReceive(T& value);
+
+        template<typename F>
+        void Receive(F&& cont);
+
+        template<typename F>
+        std::future<void> ForEach(F&& fn, const std::size_t batch_size = DEFAULT_BATCH_SIZE);
+
+        void Close();
+        bool Closed() const noexcept;
+        bool Empty() const noexcept;
+
+    private:
+
+        using item_t = std::optional<T>;
+        using receiver_t = Job<void(item_t)>;
+
+        static constexpr std::size_t UNBOUNDED_RING_SIZE{ 1024 };
+
+        struct Slot {
+            std::atomic<std::size_t> sequence;
+            item_t value;
+        };
+
+        template<typename F>
+        struct Consumer {
+            F fn;
+            std::promise<void> done;
+            const std::size_t batch_size;
+        };
+
+        ThreadPool& pool_;
+        const bool bounded_;
+        const std::size_t capacity_;
+        std::unique_ptr<Slot[]> slots_;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> receivers_;
+        std::atomic<std::size_t> senders_;
+        std::atomic<std::size_t> overflow_size_;
+        std::atomic_bool closed_;
+
+        mutable std::mutex mtx_;
+        std::condition_variable space_cv_;
+        std::deque<T> overflow_;
+        std::deque<receiver_t> waiting_;
+
+        bool Push_(T& value);
+        bool PushRing_(T& value) noexcept;
+        bool Pop_(item_t& item);
+        bool PopRing_(item_t& item) noexcept;
+        bool PopOverflow_(item_t& item);
+        bool Full_() const noexcept;
+        void Wake_();
+        void Space_();
+        void Post_(receiver_t&& receiver, item_t&& item);
+
+        template<typename F>
+        void Consume_(std::shared_ptr<Consumer<F>> consumer, item_t item);
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Channel class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    inline Channel<T>::Channel(ThreadPool& pool, const std::size_t capacity) :
+        pool_{ pool },
+        bounded_{ capacity != UNBOUNDED },
+        capacity_{ capacity != UNBOUNDED ? capacity : UNBOUNDED_RING_SIZE },
+        slots_{ std::make_unique<Slot[]>(capacity_) },
+        head_{ 0 },
+        tail_{ 0 },
+        receivers_{ 0 },
+        senders_{ 0 },
+        overflow_size_{ 0 },
+        closed_{ false },
+        mtx_{ },
+        space_cv_{ },
+        overflow_{ },
+        waiting_{ }
+    {
+        for (std::size_t index = 0; index < capacity_; ++index) {
+            slots_[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename T>
+    inline bool Channel<T>::TrySend(T value) {
+        if (closed_.load(std::memory_order_acquire) || !Push_(value)) {
+            return false;
+        }
+        Wake_();
+        return true;
+    }
+
+    template<typename T>
+    inline bool Channel<T>::Send(T value) {
+        while (!closed_.load(std::memory_order_acquire)) {
+            if (Push_(value)) {
+                Wake_();
+                return true;
+            }
+            ThreadPool::Blocking([this] {
+                std::unique_lock channel_lock(mtx_);
+                senders_.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                space_cv_.wait(channel_lock, [this] {
+                    return closed_.load(std::memory_order_relaxed) || !Full_();
+                });
+                senders_.fetch_sub(1);
+            });
+        }
+        return false;
+    }
+
+    template<typename T>
+    inline bool Channel<T>::TryReceive(T& value) {
+        item_t item;
+        if (!Pop_(item)) {
+            return false;
+        }
+        value = std::move(*item);
+        Space_();
+        return true;
+    }
+
+    template<typename T>
+    template<typename F>
+    inline void Channel<T>::Receive(F&& cont) {
+        receiver_t receiver(std::forward<F>(cont), pool_.Resource());
+        item_t item;
+        if (Pop_(item)) {
+            Space_();
+            Post_(std::move(receiver), std::move(item));
+            return;
+        }
+
+        std::unique_lock channel_lock(mtx_);
+        receivers_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (PopRing_(item) || PopOverflow_(item) || closed_.load(std::memory_order_relaxed)) {
+            receivers_.fetch_sub(1);
+            channel_lock.unlock();
+            if (item) {
+                Space_();
+            }
+            Post_(std::move(receiver), std::move(item));
+            return;
+        }
+        waiting_.push_back(std::move(receiver));
+    }
+
+    template<typename T>
+    template<typename F>
+    inline std::future<void> Channel<T>::ForEach(F&& fn, const std::size_t batch_size) {
+        auto consumer = std::make_shared<Consumer<std::decay_t<F>>>(
+            Consumer<std::decay_t<F>>{ std::forward<F>(fn), std::promise<void>{ }, batch_size > 0 ? batch_size : 1 }
+        );
+        std::future<void> result = consumer->done.get_future();
+        Receive([this, consumer](item_t item) {
+            Consume_(consumer, std::move(item));
+        });
+        return result;
+    }
+
+    template<typename T>
+    inline void Channel<T>::Close() {
+        const std::scoped_lock channel_lock(mtx_);
+        closed_.store(true, std::memory_order_release);
+        item_t item;
+        while (!waiting_.empty()) {
+            if (!PopRing_(item)) {
+                PopOverflow_(item);
+            }
+            Post_(std::move(waiting_.front()), std::move(item));
+            waiting_.pop_front();
+            receivers_.fetch_sub(1);
+            item.reset();
+        }
+        space_cv_.notify_all();
+    }
+
+    template<typename T>
+    inline bool Channel<T>::Closed() const noexcept {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    template<typename T>
+    inline bool Channel<T>::Empty() const noexcept {
+        const std::size_t position = head_.load(std::memory_order_acquire);
+        return slots_[position % capacity_].sequence.load(std::memory_order_acquire) != position + 1 &&
+            overflow_size_.load(std::memory_order_acquire) == 0;
+    }
+
+    template<typename T>
+    inline bool Channel<T>::Push_(T& value) {
+        if (overflow_size_.load(std::memory_order_acquire) == 0 && PushRing_(value)) {
+            return true;
+        }
+        if (bounded_) {
+            return false;
+        }
+        // Once values spill over, later ones follow them so each producer's
+        // values stay in order.
+        const std::scoped_lock channel_lock(mtx_);
+        overflow_.push_back(std::move(value));
+        overflow_size_.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T>
+    inline bool Channel<T>::PushRing_(T& value) noexcept {
+        std::size_t position = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[position % capacity_];
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value.emplace(std::move(value));
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename T>
+    inline bool Channel<T>::Pop_(item_t& item) {
+        if (PopRing_(item)) {
+            return true;
+        }
+        if (overflow_size_.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        const std::scoped_lock channel_lock(mtx_);
+        return PopRing_(item) || PopOverflow_(item);
+    }
+
+    template<typename T>
+    inline bool Channel<T>::PopRing_(item_t& item) noexcept {
+        std::size_t position = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[position % capacity_];
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    item = std::move(slot.value);
+                    slot.value.reset();
+                    slot.sequence.store(position + capacity_, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename T>
+    inline bool Channel<T>::PopOverflow_(item_t& item) {
+        if (overflow_.empty()) {
+            return false;
+        }
+        item.emplace(std::move(overflow_.front()));
+        overflow_.pop_front();
+        overflow_size_.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T>
+    inline bool Channel<T>::Full_() const noexcept {
+        const std::size_t position = tail_.load(std::memory_order_acquire);
+        return slots_[position % capacity_].sequence.load(std::memory_order_acquire) != position;
+    }
+
+    // Senders publish a value and then look for parked receivers; receivers
+    // register and then look for values. The fences make sure at least one
+    // side sees the other.
+
+    template<typename T>
+    inline void Channel<T>::Wake_() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (receivers_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        const std::scoped_lock channel_lock(mtx_);
+        item_t item;
+        while (!waiting_.empty() && (PopRing_(item) || PopOverflow_(item))) {
+            Post_(std::move(waiting_.front()), std::move(item));
+            waiting_.pop_front();
+            receivers_.fetch_sub(1);
+            item.reset();
+        }
+        if (senders_.load(std::memory_order_relaxed) > 0) {
+            space_cv_.notify_all();
+        }
+    }
+
+    template<typename T>
+    inline void Channel<T>::Space_() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (senders_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        const std::scoped_lock channel_lock(mtx_);
+        space_cv_.notify_all();
+    }
+
+    template<typename T>
+    inline void Channel<T>::Post_(receiver_t&& receiver, item_t&& item) {
+        pool_.AddAsyncTask([receiver = std::move(receiver), item = std::move(item)]() mutable {
+            receiver(std::move(item));
+        });
+    }
+
+    template<typename T>
+    template<typename F>
+    inline void Channel<T>::Consume_(std::shared_ptr<Consumer<F>> consumer, item_t item) {
+        if (!item) {
+            consumer->done.set_value();
+            return;
+        }
+        try {
+            consumer->fn(std::move(*item));
+            for (std::size_t count = 1; count < consumer->batch_size; ++count) {
+                item.reset();
+                if (!Pop_(item)) {
+                    break;
+                }
+                consumer->fn(std::move(*item));
+            }
+        }
+        catch (...) {
+            consumer->done.set_exception(std::current_exception());
+            return;
+        }
+        Space_();
+        Receive([this, consumer](item_t next) {
+            Consume_(consumer, std::move(next));
+        });
+    }
+
+}
+
+#endif // INCLUDE_GUARD_CHANNEL_HPP
@@ -0,0 +1,135 @@
+#ifndef INCLUDE_GUARD_COMPLETION_QUEUE_HPP
+#define INCLUDE_GUARD_COMPLETION_QUEUE_HPP
+
+#include <deque>
+#include <mutex>
+#include <cstddef>
+#include <utility>
+#include <variant>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // CompletionQueue class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Collects results of tasks in the order they finish. Each result carries
+    // the id given at submission; the queue must outlive the tasks feeding it.
+
+    template<typename T>
+    class CompletionQueue {
+    public:
+
+        CompletionQueue(const CompletionQueue&) = delete;
+        CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+    public:
+
+        using value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        struct Result {
+            std::size_t id;
+            value_t value;
+            std::exception_ptr error;
+
+            value_t& Get();
+        };
+
+        CompletionQueue() = default;
+
+        Result Pop();
+        bool TryPop(Result& result);
+
+        std::size_t Size() const noexcept;
+        bool Empty() const noexcept;
+
+        template<typename F>
+        void Complete(const std::size_t id, F& job);
+
+    private:
+
+        mutable std::mutex mtx_;
+        std::condition_variable ready_cv_;
+        std::deque<Result> results_;
+
+        void Push_(Result&& result);
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // CompletionQueue class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    inline typename CompletionQueue<T>::value_t& CompletionQueue<T>::Result::Get() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return value;
+    }
+
+    template<typename T>
+    inline typename CompletionQueue<T>::Result CompletionQueue<T>::Pop() {
+        std::unique_lock results_lock(mtx_);
+        ready_cv_.wait(results_lock, [this] { return !results_.empty(); });
+        Result result = std::move(results_.front());
+        results_.pop_front();
+        return result;
+    }
+
+    template<typename T>
+    inline bool CompletionQueue<T>::TryPop(Result& result) {
+        const std::scoped_lock results_lock(mtx_);
+        if (results_.empty()) {
+            return false;
+        }
+        result = std::move(results_.front());
+        results_.pop_front();
+        return true;
+    }
+
+    template<typename T>
+    inline std::size_t CompletionQueue<T>::Size() const noexcept {
+        const std::scoped_lock results_lock(mtx_);
+        return results_.size();
+    }
+
+    template<typename T>
+    inline bool CompletionQueue<T>::Empty() const noexcept {
+        const std::scoped_lock results_lock(mtx_);
+        return results_.empty();
+    }
+
+    template<typename T>
+    template<typename F>
+    inline void CompletionQueue<T>::Complete(const std::size_t id, F& job) {
+        Result result{ id, value_t{}, nullptr };
+        try {
+            if constexpr (std::is_void_v<T>) {
+                job();
+            }
+            else {
+                result.value = job();
+            }
+        }
+        catch (...) {
+            result.error = std::current_exception();
+        }
+        Push_(std::move(result));
+    }
+
+    template<typename T>
+    inline void CompletionQueue<T>::Push_(Result&& result) {
+        {
+            const std::scoped_lock results_lock(mtx_);
+            results_.push_back(std::move(result));
+        }
+        ready_cv_.notify_one();
+    }
+
+}
+
+#endif // INCLUDE_GUARD_COMPLETION_QUEUE_HPP
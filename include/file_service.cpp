@@ -0,0 +1,423 @@
+#include <file_service.hpp>
+#include <threadpool.hpp>
+
+#include <cerrno>
+#include <atomic>
+#include <utility>
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#endif
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FileService::Request struct defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    struct FileService::Request {
+        Operation operation;
+        int fd;
+        void* data;
+        std::size_t size;
+        std::uint64_t offset;
+        handler_t handler;
+        Delivery delivery;
+#if !defined(_WIN32)
+        iovec iov;
+#endif
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FileService::Ring struct defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+#if defined(__linux__)
+
+    struct FileService::Ring {
+        int fd{ -1 };
+        int event_fd{ -1 };
+        void* sq_ptr{ MAP_FAILED };
+        std::size_t sq_size{ 0 };
+        void* cq_ptr{ MAP_FAILED };
+        std::size_t cq_size{ 0 };
+        io_uring_sqe* sqes{ static_cast<io_uring_sqe*>(MAP_FAILED) };
+        std::size_t sqes_size{ 0 };
+
+        unsigned* sq_head{ nullptr };
+        unsigned* sq_tail{ nullptr };
+        unsigned* sq_array{ nullptr };
+        unsigned sq_mask{ 0 };
+        unsigned sq_entries{ 0 };
+        unsigned* cq_head{ nullptr };
+        unsigned* cq_tail{ nullptr };
+        io_uring_cqe* cqes{ nullptr };
+        unsigned cq_mask{ 0 };
+        unsigned cq_entries{ 0 };
+
+        std::mutex sq_mutex;
+        std::mutex cq_mutex;
+        std::deque<Request*> overflow;
+        std::size_t inflight{ 0 };
+
+        static std::unique_ptr<Ring> Open(const unsigned entries);
+        ~Ring();
+
+        int Enter(const unsigned to_submit, const unsigned min_complete, const unsigned flags) noexcept;
+        bool Push(Request* request) noexcept;
+        void Flush() noexcept;
+    };
+
+    std::unique_ptr<FileService::Ring> FileService::Ring::Open(const unsigned entries) {
+        io_uring_params params{};
+        auto ring = std::make_unique<Ring>();
+        ring->fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (ring->fd < 0) {
+            return nullptr;
+        }
+
+        ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            ring->sq_size = ring->cq_size = std::max(ring->sq_size, ring->cq_size);
+        }
+        ring->sq_ptr = ::mmap(nullptr, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+        if (ring->sq_ptr == MAP_FAILED) {
+            return nullptr;
+        }
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            ring->cq_ptr = ring->sq_ptr;
+        }
+        else {
+            ring->cq_ptr = ::mmap(nullptr, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+            if (ring->cq_ptr == MAP_FAILED) {
+                return nullptr;
+            }
+        }
+        ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        ring->sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES));
+        if (ring->sqes == MAP_FAILED) {
+            return nullptr;
+        }
+
+        std::byte* const sq = static_cast<std::byte*>(ring->sq_ptr);
+        std::byte* const cq = static_cast<std::byte*>(ring->cq_ptr);
+        ring->sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        ring->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        ring->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        ring->sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        ring->sq_entries = params.sq_entries;
+        ring->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        ring->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        ring->cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        ring->cq_entries = params.cq_entries;
+
+        ring->event_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (ring->event_fd < 0) {
+            return nullptr;
+        }
+        if (::syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_EVENTFD, &ring->event_fd, 1) < 0) {
+            return nullptr;
+        }
+        return ring;
+    }
+
+    FileService::Ring::~Ring() {
+        if (sqes != MAP_FAILED) {
+            ::munmap(sqes, sqes_size);
+        }
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+            ::munmap(cq_ptr, cq_size);
+        }
+        if (sq_ptr != MAP_FAILED) {
+            ::munmap(sq_ptr, sq_size);
+        }
+        if (event_fd >= 0) {
+            ::close(event_fd);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    int FileService::Ring::Enter(const unsigned to_submit, const unsigned min_complete, const unsigned flags) noexcept {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    bool FileService::Ring::Push(Request* request) noexcept {
+        if (inflight >= cq_entries) {
+            return false;
+        }
+        const unsigned tail = *sq_tail;
+        if (tail - std::atomic_ref<unsigned>(*sq_head).load(std::memory_order_acquire) >= sq_entries) {
+            return false;
+        }
+
+        const unsigned index = tail & sq_mask;
+        io_uring_sqe& sqe = sqes[index];
+        sqe = io_uring_sqe{};
+        sqe.fd = request->fd;
+        sqe.user_data = reinterpret_cast<std::uint64_t>(request);
+        switch (request->operation) {
+            case Operation::READ: {
+                sqe.opcode = IORING_OP_READV;
+            } break;
+            case Operation::WRITE: {
+                sqe.opcode = IORING_OP_WRITEV;
+            } break;
+            default: { // Operation::FSYNC
+                sqe.opcode = IORING_OP_FSYNC;
+            }
+        }
+        if (request->operation != Operation::FSYNC) {
+            request->iov.iov_base = request->data;
+            request->iov.iov_len = request->size;
+            sqe.addr = reinterpret_cast<std::uint64_t>(&request->iov);
+            sqe.len = 1;
+            sqe.off = request->offset;
+        }
+        sq_array[index] = index;
+        std::atomic_ref<unsigned>(*sq_tail).store(tail + 1, std::memory_order_release);
+        ++inflight;
+        return true;
+    }
+
+    void FileService::Ring::Flush() noexcept {
+        const unsigned pending = *sq_tail - std::atomic_ref<unsigned>(*sq_head).load(std::memory_order_acquire);
+        if (pending > 0) {
+            while (Enter(pending, 0, 0) < 0 && errno == EINTR);
+        }
+    }
+
+#else
+
+    struct FileService::Ring {};
+
+#endif
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FileService class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    FileService::FileService(ThreadPool& pool) :
+        FileService(pool, DEFAULT_BLOCKING_THREADS)
+    {}
+
+    FileService::FileService(ThreadPool& pool, const std::size_t blocking_threads) :
+        pool_{ pool },
+        ring_{ },
+        reaper_{ },
+        reaping_{ false },
+        blocking_count_{ blocking_threads > 0 ? blocking_threads : 1 },
+        blocking_threads_{ },
+        blocking_requests_{ },
+        blocking_mutex_{ },
+        blocking_cv_{ },
+        blocking_working_{ false }
+    {
+#if defined(__linux__)
+        ring_ = Ring::Open(RING_ENTRIES);
+        if (ring_) {
+            reaping_ = true;
+            reaper_ = std::thread(&FileService::ProcessRing_, this);
+            return;
+        }
+#endif
+        StartBlocking_();
+    }
+
+    FileService::~FileService() {
+#if defined(__linux__)
+        if (ring_) {
+            // The reaper drains whatever is still in flight before it exits.
+            reaping_.store(false, std::memory_order_release);
+            const std::uint64_t wake{ 1 };
+            [[maybe_unused]] const ssize_t written = ::write(ring_->event_fd, &wake, sizeof(wake));
+            reaper_.join();
+            return;
+        }
+#endif
+        StopBlocking_();
+    }
+
+    void FileService::Submit(const Operation operation, const int fd, void* data, const std::size_t size, const std::uint64_t offset, handler_t handler, const Delivery delivery) {
+        auto request = std::make_unique<Request>();
+        request->operation = operation;
+        request->fd = fd;
+        request->data = data;
+        request->size = size;
+        request->offset = offset;
+        request->handler = std::move(handler);
+        request->delivery = delivery;
+
+#if defined(__linux__)
+        if (ring_) {
+            const std::scoped_lock sq_lock(ring_->sq_mutex);
+            if (!ring_->overflow.empty() || !ring_->Push(request.get())) {
+                ring_->overflow.push_back(request.get());
+            }
+            request.release();
+            ring_->Flush();
+            return;
+        }
+#endif
+
+        {
+            const std::scoped_lock blocking_lock(blocking_mutex_);
+            blocking_requests_.push_back(std::move(request));
+        }
+        blocking_cv_.notify_one();
+    }
+
+    bool FileService::UsesIoUring() const noexcept {
+        return static_cast<bool>(ring_);
+    }
+
+    void FileService::StartBlocking_() {
+        blocking_working_ = true;
+        blocking_threads_ = std::make_unique<std::thread[]>(blocking_count_);
+        for (std::size_t index = 0; index < blocking_count_; ++index) {
+            blocking_threads_[index] = std::thread(&FileService::ProcessBlocking_, this);
+        }
+    }
+
+    void FileService::StopBlocking_() {
+        {
+            const std::scoped_lock blocking_lock(blocking_mutex_);
+            blocking_working_ = false;
+        }
+        blocking_cv_.notify_all();
+        for (std::size_t index = 0; index < blocking_count_; ++index) {
+            blocking_threads_[index].join();
+        }
+    }
+
+    void FileService::ProcessBlocking_() {
+        std::unique_lock blocking_lock(blocking_mutex_);
+        while (true) {
+            blocking_cv_.wait(blocking_lock, [this] {
+                return !blocking_requests_.empty() || !blocking_working_;
+            });
+            if (blocking_requests_.empty()) {
+                break;
+            }
+            std::unique_ptr<Request> request = std::move(blocking_requests_.front());
+            blocking_requests_.pop_front();
+            blocking_lock.unlock();
+
+            long result{ 0 };
+#if !defined(_WIN32)
+            do {
+                switch (request->operation) {
+                    case Operation::READ: {
+                        result = static_cast<long>(::pread(request->fd, request->data, request->size, static_cast<off_t>(request->offset)));
+                        if (result < 0 && errno == ESPIPE) { // pipes and sockets have no offset, as with io_uring
+                            result = static_cast<long>(::read(request->fd, request->data, request->size));
+                        }
+                    } break;
+                    case Operation::WRITE: {
+                        result = static_cast<long>(::pwrite(request->fd, request->data, request->size, static_cast<off_t>(request->offset)));
+                        if (result < 0 && errno == ESPIPE) {
+                            result = static_cast<long>(::write(request->fd, request->data, request->size));
+                        }
+                    } break;
+                    default: { // Operation::FSYNC
+                        result = ::fsync(request->fd);
+                    }
+                }
+            } while (result < 0 && errno == EINTR);
+            if (result < 0) {
+                result = -errno;
+            }
+#else
+            result = -ENOSYS;
+#endif
+            Deliver_(std::move(request), result);
+
+            blocking_lock.lock();
+        }
+    }
+
+    void FileService::ProcessRing_() {
+#if defined(__linux__)
+        pollfd ready{ ring_->event_fd, POLLIN, 0 };
+        while (true) {
+            {
+                const std::scoped_lock sq_lock(ring_->sq_mutex);
+                if (!reaping_.load(std::memory_order_acquire) && ring_->inflight == 0 && ring_->overflow.empty()) {
+                    break;
+                }
+            }
+            if (::poll(&ready, 1, -1) < 0 && errno != EINTR) {
+                break;
+            }
+            Reap_();
+        }
+#endif
+    }
+
+    void FileService::Reap_() {
+#if defined(__linux__)
+        std::uint64_t counter{ 0 };
+        while (::read(ring_->event_fd, &counter, sizeof(counter)) > 0);
+
+        std::vector<std::pair<Request*, long>> completed;
+        {
+            const std::scoped_lock cq_lock(ring_->cq_mutex);
+            unsigned head = *ring_->cq_head;
+            const unsigned tail = std::atomic_ref<unsigned>(*ring_->cq_tail).load(std::memory_order_acquire);
+            completed.reserve(tail - head);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = ring_->cqes[head & ring_->cq_mask];
+                completed.emplace_back(reinterpret_cast<Request*>(cqe.user_data), static_cast<long>(cqe.res));
+            }
+            std::atomic_ref<unsigned>(*ring_->cq_head).store(head, std::memory_order_release);
+        }
+
+        if (!completed.empty()) {
+            const std::scoped_lock sq_lock(ring_->sq_mutex);
+            ring_->inflight -= completed.size();
+            while (!ring_->overflow.empty() && ring_->Push(ring_->overflow.front())) {
+                ring_->overflow.pop_front();
+            }
+            ring_->Flush();
+        }
+
+        for (auto& [request, result] : completed) {
+            Deliver_(std::unique_ptr<Request>(request), result);
+        }
+#endif
+    }
+
+    void FileService::Deliver_(std::unique_ptr<Request> request, const long result) {
+        if (request->delivery == Delivery::INLINE) {
+            Complete_(*request, result);
+            return;
+        }
+        std::shared_ptr<Request> completed(std::move(request));
+        pool_.AddAsyncTask([completed, result]() {
+            Complete_(*completed, result);
+        });
+    }
+
+    void FileService::Complete_(Request& request, const long result) {
+        if (result < 0) {
+            request.handler(std::error_code(static_cast<int>(-result), std::system_category()), 0);
+        }
+        else {
+            request.handler(std::error_code{}, static_cast<std::size_t>(result));
+        }
+    }
+
+}
@@ -0,0 +1,90 @@
+#ifndef INCLUDE_GUARD_FILE_SERVICE_HPP
+#define INCLUDE_GUARD_FILE_SERVICE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <system_error>
+#include <condition_variable>
+
+namespace vsock {
+
+    class ThreadPool;
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FileService class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class FileService {
+    public:
+
+        FileService(const FileService&) = delete;
+        FileService& operator=(const FileService&) = delete;
+
+    public:
+
+        enum class Operation : std::uint8_t {
+            READ,
+            WRITE,
+            FSYNC
+        };
+
+        // Where a completion handler runs. POOL posts it to the pool as a
+        // task; INLINE runs it on the service thread that reaped it, which
+        // suits handlers that only fulfil a promise: a task can then wait on
+        // its own I/O even when every worker is busy.
+        enum class Delivery : std::uint8_t {
+            POOL,
+            INLINE
+        };
+
+        using handler_t = std::function<void(std::error_code, std::size_t)>;
+
+        static constexpr std::size_t DEFAULT_BLOCKING_THREADS{ 4 };
+        static constexpr unsigned RING_ENTRIES{ 256 };
+
+        FileService(ThreadPool& pool);
+        FileService(ThreadPool& pool, const std::size_t blocking_threads);
+        ~FileService();
+
+        void Submit(const Operation operation, const int fd, void* data, const std::size_t size, const std::uint64_t offset, handler_t handler, const Delivery delivery = Delivery::POOL);
+        bool UsesIoUring() const noexcept;
+
+    private:
+
+        struct Request;
+        struct Ring;
+
+        ThreadPool& pool_;
+        std::unique_ptr<Ring> ring_;
+        std::thread reaper_;
+        std::atomic_bool reaping_;
+
+        std::size_t blocking_count_;
+        std::unique_ptr<std::thread[]> blocking_threads_;
+        std::deque<std::unique_ptr<Request>> blocking_requests_;
+        std::mutex blocking_mutex_;
+        std::condition_variable blocking_cv_;
+        bool blocking_working_;
+
+        void StartBlocking_();
+        void StopBlocking_();
+        void ProcessBlocking_();
+        void ProcessRing_();
+        void Reap_();
+
+        void Deliver_(std::unique_ptr<Request> request, const long result);
+
+        static void Complete_(Request& request, const long result);
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_FILE_SERVICE_HPP
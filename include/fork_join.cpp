@@ -0,0 +1,98 @@
+#include <fork_join.hpp>
+#include <threadpool.hpp>
+
+#include <thread>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpawnFrame class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    SpawnFrame::SpawnFrame(SpawnScope& scope, const run_t run) noexcept :
+        scope_{ scope },
+        run_{ run }
+    {}
+
+    void SpawnFrame::Execute() noexcept {
+        // The frame is destroyed by run_, and the scope may be gone as soon as
+        // pending_ drops, so it is the very last thing touched.
+        SpawnScope& scope = scope_;
+        try {
+            run_(*this);
+        }
+        catch (...) {
+            scope.Fail_(std::current_exception());
+        }
+        scope.pending_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpawnScope class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    SpawnScope::SpawnScope() :
+        context_{ WorkerContext::Current() },
+        marker_{ },
+        pending_{ 0 },
+        failed_{ },
+        error_{ }
+    {
+        if (context_) {
+            marker_ = context_->scratch_.Mark();
+        }
+    }
+
+    SpawnScope::~SpawnScope() {
+        Wait_();
+        if (context_) {
+            context_->scratch_.Rewind(marker_);
+        }
+    }
+
+    void SpawnScope::Sync() {
+        Wait_();
+        if (std::exception_ptr error = std::exchange(error_, nullptr)) {
+            failed_.clear();
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool SpawnScope::Push_(SpawnFrame& frame) noexcept {
+        if (!context_->spawns_.Push(&frame)) {
+            return false;
+        }
+        if (ThreadPool* const pool = context_->pool_) {
+            pool->NotifySpawn_();
+        }
+        return true;
+    }
+
+    void SpawnScope::Wait_() noexcept {
+        while (pending_.load(std::memory_order_acquire) > 0) {
+            // Children not yet stolen sit on top of the deque, newest first.
+            if (SpawnFrame* const frame = context_->spawns_.Pop()) {
+                if (&frame->scope_ == this) {
+                    frame->Execute();
+                    continue;
+                }
+                // An enclosing scope's child: all of ours were stolen, so
+                // leave it for its owner and help elsewhere meanwhile.
+                context_->spawns_.Push(frame);
+            }
+            ThreadPool* const pool = context_->pool_;
+            if (SpawnFrame* const frame = pool ? pool->StealFrame_(context_->index_) : nullptr) {
+                frame->Execute();
+                continue;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void SpawnScope::Fail_(std::exception_ptr error) noexcept {
+        if (!failed_.test_and_set(std::memory_order_acq_rel)) {
+            error_ = std::move(error);
+        }
+    }
+
+}
@@ -0,0 +1,150 @@
+#ifndef INCLUDE_GUARD_FORK_JOIN_HPP
+#define INCLUDE_GUARD_FORK_JOIN_HPP
+
+#include <new>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <exception>
+#include <functional>
+#include <type_traits>
+
+#include <worker.hpp>
+
+namespace vsock {
+
+    class SpawnScope;
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpawnFrame class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class SpawnFrame {
+    public:
+
+        SpawnFrame(const SpawnFrame&) = delete;
+        SpawnFrame& operator=(const SpawnFrame&) = delete;
+
+    public:
+
+        void Execute() noexcept;
+
+    protected:
+
+        using run_t = void (*)(SpawnFrame&);
+
+        SpawnFrame(SpawnScope& scope, const run_t run) noexcept;
+        ~SpawnFrame() = default;
+
+    private:
+
+        friend class SpawnScope;
+
+        SpawnScope& scope_;
+        const run_t run_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpawnScope class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Cilk-style fork-join inside a pool task. Spawn() pushes the child onto
+    // the current worker's deque, where idle workers may steal it; Sync() runs
+    // the children nobody took inline and helps with stolen work until all are
+    // done, then rethrows the first child exception. Child frames live in the
+    // worker's scratch arena, which is rewound to its state at construction
+    // when the scope ends. Off the pool, children run inline at Spawn().
+
+    class SpawnScope {
+    public:
+
+        SpawnScope(const SpawnScope&) = delete;
+        SpawnScope& operator=(const SpawnScope&) = delete;
+
+    public:
+
+        SpawnScope();
+        ~SpawnScope();
+
+        template<typename F>
+        void Spawn(F&& fn);
+
+        void Sync();
+
+    private:
+
+        friend class SpawnFrame;
+
+        template<typename F>
+        class Closure final : public SpawnFrame {
+        public:
+
+            Closure(SpawnScope& scope, F&& fn);
+
+        private:
+
+            F fn_;
+
+            static void Run_(SpawnFrame& frame);
+
+        };
+
+        WorkerContext* context_;
+        ScratchArena::Marker marker_;
+        std::atomic<std::size_t> pending_;
+        std::atomic_flag failed_;
+        std::exception_ptr error_;
+
+        bool Push_(SpawnFrame& frame) noexcept;
+        void Wait_() noexcept;
+        void Fail_(std::exception_ptr error) noexcept;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpawnScope class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename F>
+    inline SpawnScope::Closure<F>::Closure(SpawnScope& scope, F&& fn) :
+        SpawnFrame(scope, &Closure::Run_),
+        fn_{ std::move(fn) }
+    {}
+
+    template<typename F>
+    inline void SpawnScope::Closure<F>::Run_(SpawnFrame& frame) {
+        Closure& self = static_cast<Closure&>(frame);
+        try {
+            std::invoke(self.fn_);
+        }
+        catch (...) {
+            self.~Closure();
+            throw;
+        }
+        self.~Closure();
+    }
+
+    template<typename F>
+    inline void SpawnScope::Spawn(F&& fn) {
+        using closure_t = Closure<std::decay_t<F>>;
+        if (!context_) {
+            try {
+                std::invoke(std::forward<F>(fn));
+            }
+            catch (...) {
+                Fail_(std::current_exception());
+            }
+            return;
+        }
+        void* memory = context_->Scratch().Allocate(sizeof(closure_t), alignof(closure_t));
+        closure_t* closure = new (memory) closure_t(*this, std::decay_t<F>(std::forward<F>(fn)));
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        if (!Push_(*closure)) {
+            closure->Execute();
+        }
+    }
+
+}
+
+#endif // INCLUDE_GUARD_FORK_JOIN_HPP
@@ -0,0 +1,137 @@
+#ifndef INCLUDE_GUARD_JOB_HPP
+#define INCLUDE_GUARD_JOB_HPP
+
+#include <new>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <memory_resource>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Job class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Move-only type-erased callable whose target lives in a memory resource.
+
+    template<typename Signature>
+    class Job;
+
+    template<typename R, typename... Args>
+    class Job<R(Args...)> {
+    public:
+
+        Job(const Job&) = delete;
+        Job& operator=(const Job&) = delete;
+
+    public:
+
+        Job() noexcept;
+        Job(Job&& other) noexcept;
+        Job& operator=(Job&& rhs) noexcept;
+        ~Job();
+
+        template<typename F>
+        Job(F&& fn, std::pmr::memory_resource* resource);
+
+        R operator()(Args... args);
+        explicit operator bool() const noexcept;
+
+        void Reset() noexcept;
+
+    private:
+
+        struct Base {
+            virtual ~Base() = default;
+            virtual R Invoke(Args... args) = 0;
+            virtual void Destroy(std::pmr::memory_resource* resource) noexcept = 0;
+        };
+
+        template<typename F>
+        struct Holder final : Base {
+            explicit Holder(F&& fn) : fn{ std::move(fn) } {}
+            R Invoke(Args... args) override { return std::invoke(fn, std::forward<Args>(args)...); }
+            void Destroy(std::pmr::memory_resource* resource) noexcept override {
+                this->~Holder();
+                resource->deallocate(this, sizeof(Holder), alignof(Holder));
+            }
+            F fn;
+        };
+
+        Base* target_;
+        std::pmr::memory_resource* resource_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Job class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename R, typename... Args>
+    inline Job<R(Args...)>::Job() noexcept :
+        target_{ nullptr },
+        resource_{ nullptr }
+    {}
+
+    template<typename R, typename... Args>
+    inline Job<R(Args...)>::Job(Job&& other) noexcept :
+        target_{ std::exchange(other.target_, nullptr) },
+        resource_{ std::exchange(other.resource_, nullptr) }
+    {}
+
+    template<typename R, typename... Args>
+    inline Job<R(Args...)>& Job<R(Args...)>::operator=(Job&& rhs) noexcept {
+        if (this != &rhs) {
+            Reset();
+            target_ = std::exchange(rhs.target_, nullptr);
+            resource_ = std::exchange(rhs.resource_, nullptr);
+        }
+        return *this;
+    }
+
+    template<typename R, typename... Args>
+    inline Job<R(Args...)>::~Job() {
+        Reset();
+    }
+
+    template<typename R, typename... Args>
+    template<typename F>
+    inline Job<R(Args...)>::Job(F&& fn, std::pmr::memory_resource* resource) :
+        target_{ nullptr },
+        resource_{ resource }
+    {
+        using holder_t = Holder<std::decay_t<F>>;
+        void* memory = resource_->allocate(sizeof(holder_t), alignof(holder_t));
+        try {
+            target_ = new (memory) holder_t(std::decay_t<F>(std::forward<F>(fn)));
+        }
+        catch (...) {
+            resource_->deallocate(memory, sizeof(holder_t), alignof(holder_t));
+            throw;
+        }
+    }
+
+    template<typename R, typename... Args>
+    inline R Job<R(Args...)>::operator()(Args... args) {
+        if (!target_) {
+            throw std::bad_function_call();
+        }
+        return target_->Invoke(std::forward<Args>(args)...);
+    }
+
+    template<typename R, typename... Args>
+    inline Job<R(Args...)>::operator bool() const noexcept {
+        return target_ != nullptr;
+    }
+
+    template<typename R, typename... Args>
+    inline void Job<R(Args...)>::Reset() noexcept {
+        if (target_) {
+            std::exchange(target_, nullptr)->Destroy(resource_);
+        }
+    }
+
+}
+
+#endif // INCLUDE_GUARD_JOB_HPP
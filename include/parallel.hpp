@@ -0,0 +1,349 @@
+#ifndef INCLUDE_GUARD_PARALLEL_HPP
+#define INCLUDE_GUARD_PARALLEL_HPP
+
+#include <array>
+#include <bit>
+#include <vector>
+#include <future>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+
+#include <threadpool.hpp>
+
+namespace vsock::par {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Parallel algorithms declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Drop-in counterparts of the std:: algorithms that split the range over a
+    // ThreadPool. Work is cut into blocks of about BLOCK_BYTES so each stays in
+    // a core's L2; ranges below SEQUENTIAL_CUTOFF elements run the std:: version
+    // on the calling thread. Called from a task of the same pool, the block
+    // range is halved recursively with SpawnScope, otherwise the caller runs
+    // the first block and waits for the rest inside ThreadPool::Blocking. The
+    // first exception thrown by a block is rethrown once every block has
+    // finished.
+
+    inline constexpr std::size_t BLOCK_BYTES{ 256 * 1024 };
+    inline constexpr std::size_t SEQUENTIAL_CUTOFF{ 32 * 1024 };
+    inline constexpr std::size_t REDUCE_LANES{ 8 };
+
+    // Stable merge sort: sorted runs, one per worker, then merge rounds whose
+    // outputs are split by merge path so every round uses the whole pool.
+    // The value type must be default constructible.
+    template<std::random_access_iterator RandomIt, typename Compare = std::less<>>
+    void Sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare comp = {});
+
+    // Two passes: block totals in parallel, a short serial scan over them, then
+    // every block scanned in parallel from its offset. op must be associative;
+    // out may equal first.
+    template<std::random_access_iterator InputIt, std::random_access_iterator OutputIt, typename BinaryOp = std::plus<>>
+    OutputIt InclusiveScan(ThreadPool& pool, InputIt first, InputIt last, OutputIt out, BinaryOp op = {});
+
+    template<std::random_access_iterator InputIt, std::random_access_iterator OutputIt, typename T, typename BinaryOp = std::plus<>>
+    OutputIt ExclusiveScan(ThreadPool& pool, InputIt first, InputIt last, OutputIt out, T init, BinaryOp op = {});
+
+    // reduce must be associative and commutative, as for std::transform_reduce:
+    // blocks fold into REDUCE_LANES independent accumulators so the inner loop
+    // vectorizes.
+    template<std::random_access_iterator InputIt, typename T, typename Reduce, typename Transform>
+    T TransformReduce(ThreadPool& pool, InputIt first, InputIt last, T init, Reduce reduce, Transform transform);
+
+    // Inner product: init + sum of first1[i] * first2[i].
+    template<std::random_access_iterator InputIt1, std::random_access_iterator InputIt2, typename T>
+    T TransformReduce(ThreadPool& pool, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Parallel algorithms definition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    constexpr std::size_t BlockSize_() noexcept {
+        return std::max<std::size_t>(BLOCK_BYTES / sizeof(T), 1024);
+    }
+
+    // Spawns the upper half and recurses into the lower one, so a worker's
+    // deque holds one frame per level however many blocks there are, and
+    // thieves take the biggest halves first.
+    template<typename F>
+    void SplitBlocks_(const std::size_t first, const std::size_t last, F& fn) {
+        if (last - first == 1) {
+            fn(first);
+            return;
+        }
+        const std::size_t middle = first + (last - first) / 2;
+        SpawnScope scope;
+        scope.Spawn([&fn, middle, last] { SplitBlocks_(middle, last, fn); });
+        SplitBlocks_(first, middle, fn);
+        scope.Sync();
+    }
+
+    template<typename F>
+    void ForEachBlock_(ThreadPool& pool, const std::size_t blocks, F&& fn) {
+        if (blocks == 0) {
+            return;
+        }
+        const WorkerContext* const context = WorkerContext::Current();
+        if (context && context->Pool() == &pool) {
+            SplitBlocks_(0, blocks, fn);
+            return;
+        }
+        std::vector<std::future<void>> pending;
+        pending.reserve(blocks - 1);
+        for (std::size_t block = 1; block < blocks; ++block) {
+            pending.push_back(pool.AddSyncTask([&fn, block] { fn(block); }));
+        }
+        std::exception_ptr error;
+        try {
+            fn(0);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        ThreadPool::Blocking([&pending, &error] {
+            for (std::future<void>& result : pending) {
+                try {
+                    result.get();
+                }
+                catch (...) {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    template<typename It, typename BinaryOp>
+    auto FoldBlock_(It first, const It last, BinaryOp& op) {
+        std::iter_value_t<It> acc = *first;
+        for (++first; first != last; ++first) {
+            acc = op(std::move(acc), *first);
+        }
+        return acc;
+    }
+
+    // Folds element(0) .. element(size - 1) into REDUCE_LANES accumulators.
+    template<typename Reduce, typename Element>
+    auto ReduceBlock_(const std::size_t size, Reduce& reduce, Element&& element) {
+        using value_t = std::decay_t<std::invoke_result_t<Element&, std::size_t>>;
+        if (size < REDUCE_LANES * 2) {
+            value_t acc = element(0);
+            for (std::size_t index = 1; index < size; ++index) {
+                acc = reduce(std::move(acc), element(index));
+            }
+            return acc;
+        }
+        std::array<value_t, REDUCE_LANES> lanes = [&]<std::size_t... Lane>(std::index_sequence<Lane...>) {
+            return std::array<value_t, REDUCE_LANES>{ element(Lane)... };
+        }(std::make_index_sequence<REDUCE_LANES>{});
+        std::size_t index = REDUCE_LANES;
+        for (; index + REDUCE_LANES <= size; index += REDUCE_LANES) {
+            for (std::size_t lane = 0; lane < REDUCE_LANES; ++lane) {
+                lanes[lane] = reduce(lanes[lane], element(index + lane));
+            }
+        }
+        value_t acc = std::move(lanes[0]);
+        for (std::size_t lane = 1; lane < REDUCE_LANES; ++lane) {
+            acc = reduce(std::move(acc), std::move(lanes[lane]));
+        }
+        for (; index < size; ++index) {
+            acc = reduce(std::move(acc), element(index));
+        }
+        return acc;
+    }
+
+    // Split point of merging [a, a + size_a) and [b, b + size_b): the first
+    // diagonal outputs take the returned count from a, the rest from b. Ties
+    // go to a, matching std::merge.
+    template<typename It, typename Compare>
+    std::size_t MergePath_(const It a, const std::size_t size_a, const It b, const std::size_t size_b, const std::size_t diagonal, Compare& comp) {
+        std::size_t low = diagonal > size_b ? diagonal - size_b : 0;
+        std::size_t high = std::min(diagonal, size_a);
+        while (low < high) {
+            const std::size_t taken = low + (high - low) / 2;
+            const std::size_t other = diagonal - taken;
+            if (other > 0 && !comp(b[other - 1], a[taken])) {
+                low = taken + 1;
+            }
+            else {
+                high = taken;
+            }
+        }
+        return low;
+    }
+
+    template<std::random_access_iterator RandomIt, typename Compare>
+    void Sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare comp) {
+        using value_t = std::iter_value_t<RandomIt>;
+        const std::size_t size = static_cast<std::size_t>(last - first);
+        if (size < SEQUENTIAL_CUTOFF) {
+            std::stable_sort(first, last, comp);
+            return;
+        }
+        const std::size_t runs = std::bit_ceil(std::max<std::size_t>(pool.ThreadsCount(), 2));
+        std::size_t width = (size + runs - 1) / runs;
+        ForEachBlock_(pool, runs, [&](const std::size_t run) {
+            std::stable_sort(first + std::min(size, run * width), first + std::min(size, (run + 1) * width), comp);
+        });
+
+        std::vector<value_t> buffer(size);
+        bool in_buffer{ false };
+        for (; width < size; width *= 2) {
+            const std::size_t pairs = (size + 2 * width - 1) / (2 * width);
+            const std::size_t pieces = std::max<std::size_t>(runs / pairs, 1);
+            const auto merge = [&](auto source, auto target) {
+                ForEachBlock_(pool, pairs * pieces, [&](const std::size_t task) {
+                    const std::size_t low = (task / pieces) * 2 * width;
+                    const std::size_t middle = std::min(size, low + width);
+                    const std::size_t high = std::min(size, low + 2 * width);
+                    const std::size_t piece = task % pieces;
+                    const std::size_t begin = (high - low) * piece / pieces;
+                    const std::size_t end = (high - low) * (piece + 1) / pieces;
+                    const auto a = source + low;
+                    const auto b = source + middle;
+                    const std::size_t from_a = MergePath_(a, middle - low, b, high - middle, begin, comp);
+                    const std::size_t to_a = MergePath_(a, middle - low, b, high - middle, end, comp);
+                    std::merge(std::make_move_iterator(a + from_a), std::make_move_iterator(a + to_a),
+                        std::make_move_iterator(b + (begin - from_a)), std::make_move_iterator(b + (end - to_a)),
+                        target + low + begin, comp);
+                });
+            };
+            if (in_buffer) {
+                merge(buffer.begin(), first);
+            }
+            else {
+                merge(first, buffer.begin());
+            }
+            in_buffer = !in_buffer;
+        }
+        if (in_buffer) {
+            const std::size_t block = BlockSize_<value_t>();
+            ForEachBlock_(pool, (size + block - 1) / block, [&](const std::size_t index) {
+                const auto begin = buffer.begin() + index * block;
+                std::move(begin, buffer.begin() + std::min(size, (index + 1) * block), first + index * block);
+            });
+        }
+    }
+
+    template<std::random_access_iterator InputIt, std::random_access_iterator OutputIt, typename BinaryOp>
+    OutputIt InclusiveScan(ThreadPool& pool, InputIt first, InputIt last, OutputIt out, BinaryOp op) {
+        using value_t = std::iter_value_t<InputIt>;
+        const std::size_t size = static_cast<std::size_t>(last - first);
+        if (size < SEQUENTIAL_CUTOFF) {
+            return std::inclusive_scan(first, last, out, op);
+        }
+        const std::size_t block = BlockSize_<value_t>();
+        const std::size_t blocks = (size + block - 1) / block;
+        std::vector<std::optional<value_t>> offsets(blocks);
+        ForEachBlock_(pool, blocks - 1, [&](const std::size_t index) {
+            offsets[index + 1] = FoldBlock_(first + index * block, first + (index + 1) * block, op);
+        });
+        for (std::size_t index = 2; index < blocks; ++index) {
+            offsets[index] = op(*offsets[index - 1], std::move(*offsets[index]));
+        }
+        ForEachBlock_(pool, blocks, [&](const std::size_t index) {
+            const auto begin = first + index * block;
+            const auto end = first + std::min(size, (index + 1) * block);
+            if (index == 0) {
+                std::inclusive_scan(begin, end, out, op);
+            }
+            else {
+                std::inclusive_scan(begin, end, out + index * block, op, *offsets[index]);
+            }
+        });
+        return out + size;
+    }
+
+    template<std::random_access_iterator InputIt, std::random_access_iterator OutputIt, typename T, typename BinaryOp>
+    OutputIt ExclusiveScan(ThreadPool& pool, InputIt first, InputIt last, OutputIt out, T init, BinaryOp op) {
+        using value_t = std::iter_value_t<InputIt>;
+        const std::size_t size = static_cast<std::size_t>(last - first);
+        if (size < SEQUENTIAL_CUTOFF) {
+            return std::exclusive_scan(first, last, out, std::move(init), op);
+        }
+        const std::size_t block = BlockSize_<value_t>();
+        const std::size_t blocks = (size + block - 1) / block;
+        std::vector<std::optional<T>> offsets(blocks);
+        ForEachBlock_(pool, blocks - 1, [&](const std::size_t index) {
+            offsets[index + 1] = FoldBlock_(first + index * block, first + (index + 1) * block, op);
+        });
+        offsets[0] = std::move(init);
+        for (std::size_t index = 1; index < blocks; ++index) {
+            offsets[index] = op(*offsets[index - 1], std::move(*offsets[index]));
+        }
+        ForEachBlock_(pool, blocks, [&](const std::size_t index) {
+            const auto begin = first + index * block;
+            const auto end = first + std::min(size, (index + 1) * block);
+            std::exclusive_scan(begin, end, out + index * block, *offsets[index], op);
+        });
+        return out + size;
+    }
+
+    template<std::random_access_iterator InputIt, typename T, typename Reduce, typename Transform>
+    T TransformReduce(ThreadPool& pool, InputIt first, InputIt last, T init, Reduce reduce, Transform transform) {
+        using value_t = std::decay_t<std::invoke_result_t<Transform&, std::iter_reference_t<InputIt>>>;
+        const std::size_t size = static_cast<std::size_t>(last - first);
+        if (size < SEQUENTIAL_CUTOFF) {
+            return std::transform_reduce(first, last, std::move(init), reduce, transform);
+        }
+        const std::size_t block = BlockSize_<std::iter_value_t<InputIt>>();
+        const std::size_t blocks = (size + block - 1) / block;
+        std::vector<std::optional<value_t>> partials(blocks);
+        ForEachBlock_(pool, blocks, [&](const std::size_t index) {
+            const std::size_t begin = index * block;
+            const auto data = first + begin;
+            partials[index] = ReduceBlock_(std::min(size, begin + block) - begin, reduce, [&transform, data](const std::size_t offset) {
+                return transform(data[offset]);
+            });
+        });
+        T result = std::move(init);
+        for (std::optional<value_t>& partial : partials) {
+            result = reduce(std::move(result), std::move(*partial));
+        }
+        return result;
+    }
+
+    template<std::random_access_iterator InputIt1, std::random_access_iterator InputIt2, typename T>
+    T TransformReduce(ThreadPool& pool, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init) {
+        const std::size_t size = static_cast<std::size_t>(last1 - first1);
+        if (size < SEQUENTIAL_CUTOFF) {
+            return std::transform_reduce(first1, last1, first2, std::move(init));
+        }
+        // Block sums are kept in the wider of T and the product type, as the
+        // sequential version accumulates into init.
+        using value_t = std::common_type_t<T, std::decay_t<decltype(*first1 * *first2)>>;
+        const auto product = [first1, first2](const std::size_t index) {
+            return static_cast<value_t>(first1[index] * first2[index]);
+        };
+        const std::size_t block = BlockSize_<std::iter_value_t<InputIt1>>();
+        const std::size_t blocks = (size + block - 1) / block;
+        std::vector<std::optional<value_t>> partials(blocks);
+        ForEachBlock_(pool, blocks, [&](const std::size_t index) {
+            const std::size_t begin = index * block;
+            std::plus<> reduce;
+            partials[index] = ReduceBlock_(std::min(size, begin + block) - begin, reduce, [&product, begin](const std::size_t offset) {
+                return product(begin + offset);
+            });
+        });
+        T result = std::move(init);
+        for (std::optional<value_t>& partial : partials) {
+            result = std::move(result) + std::move(*partial);
+        }
+        return result;
+    }
+
+}
+
+#endif // INCLUDE_GUARD_PARALLEL_HPP
@@ -0,0 +1,172 @@
+#include <pipeline.hpp>
+
+#include <utility>
+#include <stdexcept>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Pipeline class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Pipeline::Pipeline(ThreadPool& pool, const std::size_t max_tokens) :
+        pool_{ pool },
+        max_tokens_{ max_tokens > 0 ? max_tokens : 1 },
+        stages_{ },
+        source_mutex_{ },
+        source_{ },
+        next_seq_{ 0 },
+        exhausted_{ true },
+        done_mutex_{ },
+        done_cv_{ },
+        tokens_{ 0 },
+        error_{ }
+    {}
+
+    Pipeline::Stage::Stage(const StageType type, stage_t&& fn) :
+        type{ type },
+        fn{ std::move(fn) },
+        mtx{ },
+        next{ 0 },
+        parked{ }
+    {}
+
+    Pipeline& Pipeline::AddStage(const StageType type, stage_t stage) {
+        const std::scoped_lock done_lock(done_mutex_);
+        if (tokens_ > 0) {
+            throw std::runtime_error("pipeline is running");
+        }
+        stages_.push_back(std::make_unique<Stage>(type, std::move(stage)));
+        return *this;
+    }
+
+    void Pipeline::Run(source_t source) {
+        {
+            const std::scoped_lock done_lock(done_mutex_);
+            if (tokens_ > 0) {
+                throw std::runtime_error("pipeline is running");
+            }
+            tokens_ = max_tokens_;
+            error_ = nullptr;
+        }
+        {
+            const std::scoped_lock source_lock(source_mutex_);
+            source_ = std::move(source);
+            next_seq_ = 0;
+            exhausted_ = false;
+        }
+        for (const std::unique_ptr<Stage>& stage : stages_) {
+            stage->next = 0;
+        }
+
+        for (std::size_t token = 0; token < max_tokens_; ++token) {
+            pool_.AddAsyncTask(&Pipeline::Flow_, this, std::shared_ptr<Token>{ }, 0);
+        }
+
+        std::unique_lock done_lock(done_mutex_);
+        done_cv_.wait(done_lock, [this] { return tokens_ == 0; });
+        source_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+    std::shared_ptr<Pipeline::Token> Pipeline::Pull_() {
+        const std::scoped_lock source_lock(source_mutex_);
+        if (exhausted_) {
+            return nullptr;
+        }
+        auto token = std::make_shared<Token>(Token{ next_seq_, VarNode{ }, false });
+        try {
+            if (!source_(token->item)) {
+                exhausted_ = true;
+                return nullptr;
+            }
+        }
+        catch (...) {
+            exhausted_ = true;
+            Fail_(std::current_exception());
+            return nullptr;
+        }
+        ++next_seq_;
+        return token;
+    }
+
+    void Pipeline::Flow_(std::shared_ptr<Token> token, std::size_t stage) {
+        while (true) {
+            if (!token) {
+                token = Pull_();
+                if (!token) {
+                    Release_();
+                    return;
+                }
+                stage = 0;
+            }
+
+            for (; stage < stages_.size(); ++stage) {
+                Stage& current = *stages_[stage];
+                if (current.type == StageType::PARALLEL) {
+                    Execute_(current, *token);
+                    continue;
+                }
+
+                {
+                    const std::scoped_lock stage_lock(current.mtx);
+                    if (token->seq != current.next) {
+                        current.parked.emplace(token->seq, std::move(token));
+                        return;
+                    }
+                }
+                Execute_(current, *token);
+
+                std::shared_ptr<Token> successor;
+                {
+                    const std::scoped_lock stage_lock(current.mtx);
+                    ++current.next;
+                    const auto found = current.parked.find(current.next);
+                    if (found != current.parked.end()) {
+                        successor = std::move(found->second);
+                        current.parked.erase(found);
+                    }
+                }
+                if (successor) {
+                    pool_.AddAsyncTask(&Pipeline::Flow_, this, std::move(successor), stage);
+                }
+            }
+
+            token.reset();
+        }
+    }
+
+    void Pipeline::Execute_(Stage& stage, Token& token) {
+        if (token.failed) {
+            return;
+        }
+        try {
+            stage.fn(token.item);
+        }
+        catch (...) {
+            token.failed = true;
+            {
+                const std::scoped_lock source_lock(source_mutex_);
+                exhausted_ = true;
+            }
+            Fail_(std::current_exception());
+        }
+    }
+
+    void Pipeline::Fail_(std::exception_ptr error) {
+        const std::scoped_lock done_lock(done_mutex_);
+        if (!error_) {
+            error_ = std::move(error);
+        }
+    }
+
+    void Pipeline::Release_() {
+        const std::scoped_lock done_lock(done_mutex_);
+        if (--tokens_ == 0) {
+            done_cv_.notify_all();
+        }
+    }
+
+}
@@ -0,0 +1,91 @@
+#ifndef INCLUDE_GUARD_PIPELINE_HPP
+#define INCLUDE_GUARD_PIPELINE_HPP
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+#include <varnode.hpp>
+#include <threadpool.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Pipeline class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Items are pulled from the source one at a time and carried through the
+    // stages by the same worker. A SERIAL stage runs one item at a time in source
+    // order; items arriving early are parked and resumed by their predecessor.
+    // At most max_tokens items are in flight at once.
+
+    class Pipeline {
+    public:
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+    public:
+
+        enum class StageType : std::uint8_t {
+            SERIAL,
+            PARALLEL
+        };
+
+        using source_t = std::function<bool(VarNode&)>;
+        using stage_t = std::function<void(VarNode&)>;
+
+        Pipeline(ThreadPool& pool, const std::size_t max_tokens);
+        ~Pipeline() = default;
+
+        Pipeline& AddStage(const StageType type, stage_t stage);
+        void Run(source_t source);
+
+    private:
+
+        struct Token {
+            std::uint64_t seq;
+            VarNode item;
+            bool failed;
+        };
+
+        struct Stage {
+            Stage(const StageType type, stage_t&& fn);
+            const StageType type;
+            const stage_t fn;
+            std::mutex mtx;
+            std::uint64_t next;
+            std::map<std::uint64_t, std::shared_ptr<Token>> parked;
+        };
+
+        ThreadPool& pool_;
+        const std::size_t max_tokens_;
+        std::vector<std::unique_ptr<Stage>> stages_;
+
+        std::mutex source_mutex_;
+        source_t source_;
+        std::uint64_t next_seq_;
+        bool exhausted_;
+
+        std::mutex done_mutex_;
+        std::condition_variable done_cv_;
+        std::size_t tokens_;
+        std::exception_ptr error_;
+
+        std::shared_ptr<Token> Pull_();
+        void Flow_(std::shared_ptr<Token> token, std::size_t stage);
+        void Execute_(Stage& stage, Token& token);
+        void Fail_(std::exception_ptr error);
+        void Release_();
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_PIPELINE_HPP
@@ -0,0 +1,313 @@
+#ifndef INCLUDE_GUARD_POOL_POLICIES_HPP
+#define INCLUDE_GUARD_POOL_POLICIES_HPP
+
+#include <new>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <memory_resource>
+#include <condition_variable>
+
+#include <task.hpp>
+#include <spsc.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Queue policies
+    ////////////////////////////////////////////////////////////////////////////////
+
+    struct DequeQueue {
+
+        template<typename T>
+        class Policy {
+        public:
+
+            bool TryPush(T&& value) {
+                const std::scoped_lock queue_lock(mtx_);
+                deque_.push_back(std::move(value));
+                return true;
+            }
+
+            bool TryPop(T& value) noexcept {
+                const std::scoped_lock queue_lock(mtx_);
+                if (deque_.empty()) {
+                    return false;
+                }
+                value = std::move(deque_.front());
+                deque_.pop_front();
+                return true;
+            }
+
+            bool Empty() const noexcept {
+                const std::scoped_lock queue_lock(mtx_);
+                return deque_.empty();
+            }
+
+        private:
+
+            mutable std::mutex mtx_;
+            std::deque<T> deque_;
+
+        };
+
+    };
+
+    template<std::size_t Capacity>
+    struct RingQueue {
+
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+        template<typename T>
+        class Policy {
+        public:
+
+            Policy() :
+                slots_{ std::make_unique<Slot[]>(Capacity) },
+                head_{ 0 },
+                tail_{ 0 }
+            {
+                for (std::size_t index = 0; index < Capacity; ++index) {
+                    slots_[index].sequence.store(index, std::memory_order_relaxed);
+                }
+            }
+
+            bool TryPush(T&& value) noexcept {
+                std::size_t position = tail_.load(std::memory_order_relaxed);
+                while (true) {
+                    Slot& slot = slots_[position & (Capacity - 1)];
+                    const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                    const std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+                    if (diff == 0) {
+                        if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            slot.value = std::move(value);
+                            slot.sequence.store(position + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0) {
+                        return false;
+                    }
+                    else {
+                        position = tail_.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            bool TryPop(T& value) noexcept {
+                std::size_t position = head_.load(std::memory_order_relaxed);
+                while (true) {
+                    Slot& slot = slots_[position & (Capacity - 1)];
+                    const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                    const std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+                    if (diff == 0) {
+                        if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            value = std::move(slot.value);
+                            slot.sequence.store(position + Capacity, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0) {
+                        return false;
+                    }
+                    else {
+                        position = head_.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            bool Empty() const noexcept {
+                const std::size_t position = head_.load(std::memory_order_acquire);
+                return slots_[position & (Capacity - 1)].sequence.load(std::memory_order_acquire) != position + 1;
+            }
+
+        private:
+
+            struct Slot {
+                std::atomic<std::size_t> sequence;
+                T value;
+            };
+
+            std::unique_ptr<Slot[]> slots_;
+            alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_;
+            alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_;
+
+        };
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Wait policies
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class CondVarWait {
+    public:
+
+        template<typename Predicate>
+        void Wait(Predicate&& predicate) {
+            sleepers_.fetch_add(1);
+            {
+                std::unique_lock wait_lock(mtx_);
+                cv_.wait(wait_lock, std::forward<Predicate>(predicate));
+            }
+            sleepers_.fetch_sub(1);
+        }
+
+        void NotifyOne() noexcept {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers_.load() > 0) {
+                { const std::scoped_lock wait_lock(mtx_); }
+                cv_.notify_one();
+            }
+        }
+
+        void NotifyAll() noexcept {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers_.load() > 0) {
+                { const std::scoped_lock wait_lock(mtx_); }
+                cv_.notify_all();
+            }
+        }
+
+    private:
+
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        std::atomic<std::size_t> sleepers_{ 0 };
+
+    };
+
+    class SpinWait {
+    public:
+
+        template<typename Predicate>
+        void Wait(Predicate&& predicate) {
+            for (std::size_t spin = 0; !predicate(); ++spin) {
+                if (spin < SPINS_BEFORE_YIELD) {
+#if defined(__x86_64__) || defined(__i386__)
+                    __builtin_ia32_pause();
+#endif
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void NotifyOne() noexcept {}
+        void NotifyAll() noexcept {}
+
+    private:
+
+        static constexpr std::size_t SPINS_BEFORE_YIELD{ 256 };
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Allocation policies
+    ////////////////////////////////////////////////////////////////////////////////
+
+    struct HeapAlloc {
+
+        using pointer = std::unique_ptr<Task>;
+
+        pointer Make() {
+            return std::make_unique<Task>();
+        }
+
+    };
+
+    // Only the Task node comes from the pool. Its payload and promise state
+    // use the default resource, because a future may outlive the pool.
+    class PoolAlloc {
+    public:
+
+        using pointer = std::unique_ptr<Task>;
+
+        pointer Make() {
+            return pointer(new (&resource_) Task());
+        }
+
+    private:
+
+        std::pmr::synchronized_pool_resource resource_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Destroy policies
+    ////////////////////////////////////////////////////////////////////////////////
+
+    struct SmoothDestroy {
+
+        template<typename Pool>
+        static void OnDestroy(Pool& pool) {
+            pool.Wait();
+        }
+
+    };
+
+    struct SharpDestroy {
+
+        template<typename Pool>
+        static void OnDestroy(Pool& pool) noexcept {
+            pool.ClearTasks();
+        }
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Metrics policies
+    ////////////////////////////////////////////////////////////////////////////////
+
+    struct NoMetrics {
+
+        void OnSubmit() noexcept {}
+        void OnStart() noexcept {}
+        void OnFinish() noexcept {}
+
+    };
+
+    class CountingMetrics {
+    public:
+
+        void OnSubmit() noexcept {
+            submitted_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void OnStart() noexcept {
+            started_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void OnFinish() noexcept {
+            finished_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::uint64_t Submitted() const noexcept {
+            return submitted_.load(std::memory_order_relaxed);
+        }
+
+        std::uint64_t Started() const noexcept {
+            return started_.load(std::memory_order_relaxed);
+        }
+
+        std::uint64_t Finished() const noexcept {
+            return finished_.load(std::memory_order_relaxed);
+        }
+
+    private:
+
+        std::atomic<std::uint64_t> submitted_{ 0 };
+        std::atomic<std::uint64_t> started_{ 0 };
+        std::atomic<std::uint64_t> finished_{ 0 };
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_POOL_POLICIES_HPP
@@ -0,0 +1,70 @@
+#ifndef INCLUDE_GUARD_PROBES_HPP
+#define INCLUDE_GUARD_PROBES_HPP
+
+#include <cstdint>
+
+#include <worker.hpp>
+
+// USDT probes of provider "vsock", emitted directly as SystemTap SDT v3
+// notes so sys/sdt.h is not needed. A probe site is a single nop; tracers
+// patch it only while attached, e.g.
+//
+//   bpftrace -e 'usdt:./repo:vsock:task_end { @[arg1] = count(); }'
+//   perf probe -x ./repo sdt_vsock:park
+//
+// Every probe takes (task pointer or 0, worker index or -1, depth):
+//   submit, dequeue, requeue  depth = tasks left in that queue
+//   task_start, task_end      depth = tasks left in the worker's batch
+//   park, unpark              depth = idle workers, task = 0
+//   wait_enter, wait_exit     depth = tasks running, task = 0
+//
+// Configure with -DTHREADPOOL_PROBES=OFF (defines VSOCK_NO_PROBES) to
+// compile them out; arguments are then not evaluated.
+
+#if !defined(VSOCK_NO_PROBES) && defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__)) && (defined(__GNUC__) || defined(__clang__))
+
+namespace vsock {
+
+    inline std::int64_t ProbeWorker() noexcept {
+        const WorkerContext* context = WorkerContext::Current();
+        return context ? static_cast<std::int64_t>(context->Index()) : -1;
+    }
+
+}
+
+#define VSOCK_PROBE(name, task, worker, depth)                                              \
+    __asm__ __volatile__(                                                                   \
+        "990: nop\n"                                                                        \
+        ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                       \
+        ".balign 4\n"                                                                       \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                                  \
+        "991: .asciz \"stapsdt\"\n"                                                         \
+        "992: .balign 4\n"                                                                  \
+        "993: .8byte 990b\n"                                                                \
+        ".8byte _.stapsdt.base\n"                                                           \
+        ".8byte 0\n"                                                                        \
+        ".asciz \"vsock\"\n"                                                                \
+        ".asciz \"" #name "\"\n"                                                            \
+        ".asciz \"8@%[probe_task] -8@%[probe_worker] 8@%[probe_depth]\"\n"                  \
+        "994: .balign 4\n"                                                                  \
+        ".popsection\n"                                                                     \
+        ".ifndef _.stapsdt.base\n"                                                          \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"             \
+        ".weak _.stapsdt.base\n"                                                            \
+        ".hidden _.stapsdt.base\n"                                                          \
+        "_.stapsdt.base: .space 1\n"                                                        \
+        ".size _.stapsdt.base, 1\n"                                                         \
+        ".popsection\n"                                                                     \
+        ".endif\n"                                                                          \
+        :                                                                                   \
+        : [probe_task] "nor"(reinterpret_cast<std::uintptr_t>(task)),                       \
+          [probe_worker] "nor"(static_cast<std::int64_t>(worker)),                          \
+          [probe_depth] "nor"(static_cast<std::uint64_t>(depth)))
+
+#else
+
+#define VSOCK_PROBE(name, task, worker, depth) static_cast<void>(0)
+
+#endif
+
+#endif // INCLUDE_GUARD_PROBES_HPP
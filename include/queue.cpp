@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <queue.hpp>
+#include <probes.hpp>
 
 namespace vsock {
 
@@ -6,25 +8,105 @@ namespace vsock {
     // TaskQueue class defenition
     ////////////////////////////////////////////////////////////////////////////////    
 
+    TaskQueue::TaskQueue() :
+        TaskQueue(std::pmr::get_default_resource())
+    {}
+
+    TaskQueue::TaskQueue(std::pmr::memory_resource* resource) :
+        TaskQueue(resource, false)
+    {}
+
+    TaskQueue::TaskQueue(std::pmr::memory_resource* resource, const bool deadline_order) :
+        deque_t(resource),
+        mtx_{ },
+        deadline_order_{ deadline_order },
+        deadlines_{ resource },
+        back_sequence_{ 0 }
+    {}
+
     void TaskQueue::PushBack(value_t&& task) {
         const std::scoped_lock rw_lock(mtx_);
-        std::deque<std::unique_ptr<Task>>::push_back(std::move(task));
+        VSOCK_PROBE(submit, task.get(), ProbeWorker(), Size_() + 1);
+        Insert_(std::move(task), back_sequence_++);
+    }
+
+    void TaskQueue::Requeue(value_t&& task) {
+        const std::scoped_lock rw_lock(mtx_);
+        VSOCK_PROBE(requeue, task.get(), ProbeWorker(), Size_() + 1);
+        Insert_(std::move(task), back_sequence_++);
+    }
+
+    void TaskQueue::Insert_(value_t&& task, const std::int64_t sequence) {
+        if (deadline_order_ && task->HasDeadline()) {
+            const Task::time_point_t deadline = task->Deadline();
+            deadlines_.push_back(Deadline{ deadline, sequence, std::move(task) });
+            std::push_heap(deadlines_.begin(), deadlines_.end(), Later_);
+            return;
+        }
+        deque_t::push_back(std::move(task));
+    }
+
+    bool TaskQueue::Later_(const Deadline& left, const Deadline& right) noexcept {
+        if (left.deadline != right.deadline) {
+            return left.deadline > right.deadline;
+        }
+        return left.sequence > right.sequence;
+    }
+
+    void TaskQueue::Pop_(value_t& task) noexcept {
+        if (!deadlines_.empty()) {
+            std::pop_heap(deadlines_.begin(), deadlines_.end(), Later_);
+            task = std::move(deadlines_.back().task);
+            deadlines_.pop_back();
+            return;
+        }
+        task = std::move(deque_t::front());
+        deque_t::pop_front();
+    }
+
+    std::size_t TaskQueue::Size_() const noexcept {
+        return deque_t::size() + deadlines_.size();
+    }
+
+    bool TaskQueue::Empty_() const noexcept {
+        return deque_t::empty() && deadlines_.empty();
     }
 
     void TaskQueue::Clear() noexcept {
         const std::scoped_lock rw_lock(mtx_);
-        std::deque<std::unique_ptr<Task>>::clear();
+        deque_t::clear();
+        deadlines_.clear();
     }
 
     bool TaskQueue::Empty() const noexcept {
         const std::scoped_lock rw_lock(mtx_);
-        return std::deque<std::unique_ptr<Task>>::empty();
+        return Empty_();
     }
 
     void TaskQueue::PopFront(value_t& task) noexcept {
         const std::scoped_lock rw_lock(mtx_);
-        task = std::move(std::deque<std::unique_ptr<Task>>::front());
-        std::deque<std::unique_ptr<Task>>::pop_front();
+        Pop_(task);
+    }
+
+    bool TaskQueue::TryPopFront(value_t& task) noexcept {
+        const std::scoped_lock rw_lock(mtx_);
+        if (Empty_()) {
+            return false;
+        }
+        Pop_(task);
+        return true;
+    }
+
+    std::size_t TaskQueue::TryPopFront(deque_t& batch, const std::size_t limit, const std::size_t consumers) {
+        const std::scoped_lock rw_lock(mtx_);
+        const std::size_t size = Size_();
+        const std::size_t share = consumers > 1 ? size / consumers : size;
+        const std::size_t count = std::min(limit, std::max<std::size_t>(share, 1));
+        for (std::size_t taken = 0; taken < count && !Empty_(); ++taken) {
+            Pop_(batch.emplace_back());
+            VSOCK_PROBE(dequeue, batch.back().get(), ProbeWorker(), Size_());
+        }
+        return batch.size();
     }
 
 }
\ No newline at end of file
@@ -2,9 +2,13 @@
 #define INCLUDE_GUARD_QUEUE_HPP
 
 #include <deque>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 #include <mutex>
 #include <memory>
 #include <utility>
+#include <memory_resource>
 
 #include <task.hpp>
 
@@ -15,24 +19,53 @@ namespace vsock {
     ////////////////////////////////////////////////////////////////////////////////
 
 
-    class TaskQueue : private std::deque<std::unique_ptr<Task>> {
+    class TaskQueue : private std::pmr::deque<std::unique_ptr<Task>> {
+    public:
+
+        TaskQueue();
+        explicit TaskQueue(std::pmr::memory_resource* resource);
+        // With deadline_order, tasks with a deadline go to a binary heap and
+        // pop earliest deadline first, FIFO among equal deadlines; tasks
+        // without a deadline keep FIFO order behind them.
+        TaskQueue(std::pmr::memory_resource* resource, const bool deadline_order);
+
     private:
 
         friend class ThreadPool;
 
         using value_t = std::unique_ptr<Task>;
-        using deque_t = std::deque<value_t>;
+        using deque_t = std::pmr::deque<value_t>;
 
     private:
 
         void PushBack(value_t&& task);
+        // PushBack for a LOOP task going around again.
+        void Requeue(value_t&& task);
         void Clear() noexcept;
         bool Empty() const noexcept;
         void PopFront(value_t& task) noexcept;
+        bool TryPopFront(value_t& task) noexcept;
+        std::size_t TryPopFront(deque_t& batch, const std::size_t limit, const std::size_t consumers);
 
     private:
 
+        struct Deadline {
+            Task::time_point_t deadline;
+            std::int64_t sequence;
+            value_t task;
+        };
+
         mutable std::mutex mtx_;
+        const bool deadline_order_;
+        std::pmr::vector<Deadline> deadlines_;
+        std::int64_t back_sequence_;
+
+        void Insert_(value_t&& task, const std::int64_t sequence);
+        void Pop_(value_t& task) noexcept;
+        std::size_t Size_() const noexcept;
+        bool Empty_() const noexcept;
+
+        static bool Later_(const Deadline& left, const Deadline& right) noexcept;
 
     };
 
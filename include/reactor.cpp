@@ -0,0 +1,205 @@
+#include <reactor.hpp>
+
+#include <cerrno>
+#include <utility>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Reactor class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    struct Reactor::Registration {
+        int fd;
+        std::uint64_t id;
+        std::uint32_t events;
+        handler_t handler;
+        bool active;
+        bool running;
+    };
+
+#if defined(__linux__)
+
+    namespace {
+
+        constexpr std::uint64_t WAKE_ID{ 0 };
+        constexpr int MAX_EVENTS{ 64 };
+
+        std::uint32_t ToEpoll(const std::uint32_t events) noexcept {
+            std::uint32_t result{ EPOLLONESHOT | EPOLLERR | EPOLLHUP };
+            if (events & Reactor::EVENT_READ) {
+                result |= EPOLLIN | EPOLLRDHUP;
+            }
+            if (events & Reactor::EVENT_WRITE) {
+                result |= EPOLLOUT;
+            }
+            return result;
+        }
+
+        std::uint32_t FromEpoll(const std::uint32_t events) noexcept {
+            std::uint32_t result{ 0 };
+            if (events & (EPOLLIN | EPOLLRDHUP)) {
+                result |= Reactor::EVENT_READ;
+            }
+            if (events & EPOLLOUT) {
+                result |= Reactor::EVENT_WRITE;
+            }
+            if (events & (EPOLLERR | EPOLLHUP)) {
+                result |= Reactor::EVENT_ERROR;
+            }
+            return result;
+        }
+
+    }
+
+    Reactor::Reactor() :
+        epoll_fd_{ ::epoll_create1(EPOLL_CLOEXEC) },
+        wake_fd_{ -1 },
+        next_id_{ WAKE_ID + 1 },
+        mtx_{ },
+        registrations_{ },
+        ids_{ }
+    {
+        if (epoll_fd_ < 0) {
+            throw std::system_error(errno, std::system_category(), "epoll_create1() failed");
+        }
+        wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wake_fd_ < 0) {
+            const int error = errno;
+            ::close(epoll_fd_);
+            throw std::system_error(error, std::system_category(), "eventfd() failed");
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = WAKE_ID;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) < 0) {
+            const int error = errno;
+            ::close(wake_fd_);
+            ::close(epoll_fd_);
+            throw std::system_error(error, std::system_category(), "epoll_ctl() failed");
+        }
+    }
+
+    Reactor::~Reactor() {
+        ::close(wake_fd_);
+        ::close(epoll_fd_);
+    }
+
+    void Reactor::Add(const int fd, const std::uint32_t events, handler_t handler) {
+        const std::scoped_lock reactor_lock(mtx_);
+        if (registrations_.contains(fd)) {
+            throw std::runtime_error("descriptor is already registered");
+        }
+        auto registration = std::make_shared<Registration>(Registration{ fd, next_id_++, events, std::move(handler), true, false });
+        if (!Arm_(*registration, EPOLL_CTL_ADD)) {
+            throw std::system_error(errno, std::system_category(), "epoll_ctl() failed");
+        }
+        ids_.emplace(registration->id, registration);
+        registrations_.emplace(fd, std::move(registration));
+    }
+
+    void Reactor::Modify(const int fd, const std::uint32_t events) {
+        const std::scoped_lock reactor_lock(mtx_);
+        auto it = registrations_.find(fd);
+        if (it == registrations_.end()) {
+            throw std::runtime_error("descriptor is not registered");
+        }
+        it->second->events = events;
+        if (!it->second->running && !Arm_(*it->second, EPOLL_CTL_MOD)) {
+            throw std::system_error(errno, std::system_category(), "epoll_ctl() failed");
+        }
+    }
+
+    void Reactor::Remove(const int fd) {
+        const std::scoped_lock reactor_lock(mtx_);
+        auto it = registrations_.find(fd);
+        if (it == registrations_.end()) {
+            return;
+        }
+        it->second->active = false;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        ids_.erase(it->second->id);
+        registrations_.erase(it);
+    }
+
+    void Reactor::Poll(std::vector<Ready>& ready, const int timeout_ms) {
+        epoll_event events[MAX_EVENTS];
+        const int count = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+        if (count < 0) {
+            if (errno == EINTR) {
+                return;
+            }
+            throw std::system_error(errno, std::system_category(), "epoll_wait() failed");
+        }
+
+        const std::scoped_lock reactor_lock(mtx_);
+        for (int index = 0; index < count; ++index) {
+            if (events[index].data.u64 == WAKE_ID) {
+                std::uint64_t counter{ 0 };
+                while (::read(wake_fd_, &counter, sizeof(counter)) > 0);
+                continue;
+            }
+            auto it = ids_.find(events[index].data.u64);
+            if (it == ids_.end()) {
+                continue;
+            }
+            it->second->running = true;
+            ready.push_back(Ready{ it->second, FromEpoll(events[index].events) });
+        }
+    }
+
+    void Reactor::Dispatch(const Ready& event) {
+        event.registration->handler(event.registration->fd, event.events);
+        const std::scoped_lock reactor_lock(mtx_);
+        event.registration->running = false;
+        if (event.registration->active) {
+            [[maybe_unused]] const bool armed = Arm_(*event.registration, EPOLL_CTL_MOD);
+        }
+    }
+
+    void Reactor::Wake() noexcept {
+        const std::uint64_t counter{ 1 };
+        [[maybe_unused]] const auto written = ::write(wake_fd_, &counter, sizeof(counter));
+    }
+
+    bool Reactor::Arm_(const Registration& registration, const int operation) noexcept {
+        epoll_event event{};
+        event.events = ToEpoll(registration.events);
+        event.data.u64 = registration.id;
+        return ::epoll_ctl(epoll_fd_, operation, registration.fd, &event) == 0;
+    }
+
+#else
+
+    Reactor::Reactor() :
+        epoll_fd_{ -1 },
+        wake_fd_{ -1 },
+        next_id_{ 0 },
+        mtx_{ },
+        registrations_{ },
+        ids_{ }
+    {
+        throw std::runtime_error("reactor is not supported on this platform");
+    }
+
+    Reactor::~Reactor() = default;
+
+    void Reactor::Add(const int, const std::uint32_t, handler_t) {}
+    void Reactor::Modify(const int, const std::uint32_t) {}
+    void Reactor::Remove(const int) {}
+    void Reactor::Poll(std::vector<Ready>&, const int) {}
+    void Reactor::Dispatch(const Ready&) {}
+    void Reactor::Wake() noexcept {}
+    bool Reactor::Arm_(const Registration&, const int) noexcept { return false; }
+
+#endif
+
+}
@@ -0,0 +1,67 @@
+#ifndef INCLUDE_GUARD_REACTOR_HPP
+#define INCLUDE_GUARD_REACTOR_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Reactor class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class Reactor {
+    public:
+
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+
+    public:
+
+        static constexpr std::uint32_t EVENT_READ{ 0x1 };
+        static constexpr std::uint32_t EVENT_WRITE{ 0x2 };
+        static constexpr std::uint32_t EVENT_ERROR{ 0x4 };
+
+        using handler_t = std::function<void(int, std::uint32_t)>;
+
+        struct Registration;
+
+        struct Ready {
+            std::shared_ptr<Registration> registration;
+            std::uint32_t events;
+        };
+
+        Reactor();
+        ~Reactor();
+
+        void Add(const int fd, const std::uint32_t events, handler_t handler);
+        void Modify(const int fd, const std::uint32_t events);
+        void Remove(const int fd);
+
+        void Poll(std::vector<Ready>& ready, const int timeout_ms);
+        // Runs the handler and re-arms the descriptor unless it was removed.
+        void Dispatch(const Ready& event);
+        void Wake() noexcept;
+
+    private:
+
+        int epoll_fd_;
+        int wake_fd_;
+        std::uint64_t next_id_;
+
+        std::mutex mtx_;
+        std::unordered_map<int, std::shared_ptr<Registration>> registrations_;
+        std::unordered_map<std::uint64_t, std::shared_ptr<Registration>> ids_;
+
+        [[nodiscard]] bool Arm_(const Registration& registration, const int operation) noexcept;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_REACTOR_HPP
@@ -0,0 +1,42 @@
+#include <scheduler.hpp>
+
+namespace vsock::exec {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // OperationBase class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OperationBase::OperationBase(execute_t execute) noexcept :
+        next_{ nullptr },
+        execute_{ execute }
+    {}
+
+    void OperationBase::Enqueue_(ThreadPool& pool, OperationBase& operation) noexcept {
+        pool.AddOperation_(operation);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ScheduleSender class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ScheduleSender::ScheduleSender(ThreadPool& pool) noexcept :
+        pool_{ &pool }
+    {}
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // PoolScheduler class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    PoolScheduler::PoolScheduler(ThreadPool& pool) noexcept :
+        pool_{ &pool }
+    {}
+
+    ScheduleSender PoolScheduler::schedule() const noexcept {
+        return ScheduleSender(*pool_);
+    }
+
+    ThreadPool& PoolScheduler::Pool() const noexcept {
+        return *pool_;
+    }
+
+}
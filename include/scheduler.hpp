@@ -0,0 +1,773 @@
+#ifndef INCLUDE_GUARD_SCHEDULER_HPP
+#define INCLUDE_GUARD_SCHEDULER_HPP
+
+#include <mutex>
+#include <tuple>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <optional>
+#include <concepts>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+#include <threadpool.hpp>
+
+namespace vsock::exec {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Concepts and customization points
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Customization follows the member-function form of std::execution:
+    // sndr.connect(rcvr), op.start(), sch.schedule(), rcvr.set_value(...).
+
+    struct sender_t {};
+    struct receiver_t {};
+    struct operation_state_t {};
+    struct scheduler_t {};
+
+    template<typename... Ts>
+    struct types {};
+
+    template<typename S>
+    concept sender = std::derived_from<typename std::remove_cvref_t<S>::sender_concept, sender_t>;
+
+    template<typename R>
+    concept receiver = std::derived_from<typename std::remove_cvref_t<R>::receiver_concept, receiver_t>
+        && std::move_constructible<std::remove_cvref_t<R>>;
+
+    template<typename S>
+    using value_types_of_t = typename std::remove_cvref_t<S>::value_types;
+
+    inline constexpr struct set_value_t {
+        template<typename R, typename... Vs>
+        void operator()(R&& rcvr, Vs&&... values) const noexcept {
+            std::forward<R>(rcvr).set_value(std::forward<Vs>(values)...);
+        }
+    } set_value{};
+
+    inline constexpr struct set_error_t {
+        template<typename R>
+        void operator()(R&& rcvr, std::exception_ptr error) const noexcept {
+            std::forward<R>(rcvr).set_error(std::move(error));
+        }
+    } set_error{};
+
+    inline constexpr struct set_stopped_t {
+        template<typename R>
+        void operator()(R&& rcvr) const noexcept {
+            std::forward<R>(rcvr).set_stopped();
+        }
+    } set_stopped{};
+
+    inline constexpr struct connect_t {
+        template<sender S, receiver R>
+        auto operator()(S&& sndr, R&& rcvr) const {
+            return std::forward<S>(sndr).connect(std::forward<R>(rcvr));
+        }
+    } connect{};
+
+    inline constexpr struct start_t {
+        template<typename O>
+        void operator()(O& operation) const noexcept {
+            operation.start();
+        }
+    } start{};
+
+    inline constexpr struct schedule_t {
+        template<typename Sch>
+        auto operator()(Sch&& sch) const noexcept {
+            return std::forward<Sch>(sch).schedule();
+        }
+    } schedule{};
+
+    template<typename Sch>
+    concept scheduler = std::derived_from<typename std::remove_cvref_t<Sch>::scheduler_concept, scheduler_t>
+        && std::equality_comparable<std::remove_cvref_t<Sch>>
+        && requires(Sch&& sch) { { exec::schedule(std::forward<Sch>(sch)) } -> sender; };
+
+    template<typename S, typename R>
+    using connect_result_t = decltype(exec::connect(std::declval<S>(), std::declval<R>()));
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // OperationBase class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Intrusive node queued on the pool; lives inside the operation state.
+
+    class OperationBase {
+    public:
+
+        OperationBase(const OperationBase&) = delete;
+        OperationBase& operator=(const OperationBase&) = delete;
+
+    protected:
+
+        using execute_t = void (*)(OperationBase*) noexcept;
+
+        explicit OperationBase(execute_t execute) noexcept;
+        ~OperationBase() = default;
+
+        static void Enqueue_(ThreadPool& pool, OperationBase& operation) noexcept;
+
+    private:
+
+        friend class vsock::ThreadPool;
+
+        OperationBase* next_;
+        execute_t execute_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // PoolScheduler class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class PoolScheduler;
+
+    template<typename R>
+    class ScheduleOperation : private OperationBase {
+    public:
+
+        using operation_state_concept = operation_state_t;
+
+        ScheduleOperation(ThreadPool& pool, R&& rcvr);
+
+        void start() noexcept;
+
+    private:
+
+        ThreadPool& pool_;
+        R rcvr_;
+
+        static void Execute_(OperationBase* base) noexcept;
+
+    };
+
+    class ScheduleSender {
+    public:
+
+        using sender_concept = sender_t;
+        using value_types = types<>;
+
+        explicit ScheduleSender(ThreadPool& pool) noexcept;
+
+        template<receiver R>
+        ScheduleOperation<std::remove_cvref_t<R>> connect(R&& rcvr) const;
+
+    private:
+
+        ThreadPool* pool_;
+
+    };
+
+    class PoolScheduler {
+    public:
+
+        using scheduler_concept = scheduler_t;
+
+        explicit PoolScheduler(ThreadPool& pool) noexcept;
+
+        ScheduleSender schedule() const noexcept;
+        ThreadPool& Pool() const noexcept;
+
+        bool operator==(const PoolScheduler& other) const noexcept = default;
+
+    private:
+
+        ThreadPool* pool_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // just
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename R, typename... Ts>
+    class JustOperation {
+    public:
+
+        using operation_state_concept = operation_state_t;
+
+        JustOperation(R&& rcvr, std::tuple<Ts...>&& values);
+
+        void start() noexcept;
+
+    private:
+
+        R rcvr_;
+        std::tuple<Ts...> values_;
+
+    };
+
+    template<typename... Ts>
+    class JustSender {
+    public:
+
+        using sender_concept = sender_t;
+        using value_types = types<Ts...>;
+
+        explicit JustSender(Ts... values);
+
+        template<receiver R>
+        JustOperation<std::remove_cvref_t<R>, Ts...> connect(R&& rcvr) &&;
+
+    private:
+
+        std::tuple<Ts...> values_;
+
+    };
+
+    template<typename... Vs>
+    JustSender<std::decay_t<Vs>...> just(Vs&&... values);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // then
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename R, typename F>
+    class ThenReceiver {
+    public:
+
+        using receiver_concept = receiver_t;
+
+        ThenReceiver(R&& rcvr, F&& fn);
+
+        template<typename... Vs>
+        void set_value(Vs&&... values) && noexcept;
+        void set_error(std::exception_ptr error) && noexcept;
+        void set_stopped() && noexcept;
+
+    private:
+
+        R rcvr_;
+        F fn_;
+
+    };
+
+    template<typename F, typename Types>
+    struct ThenValueTypes;
+
+    template<typename F, typename... Ts>
+    struct ThenValueTypes<F, types<Ts...>> {
+        using result_t = std::invoke_result_t<F, Ts...>;
+        using type = std::conditional_t<std::is_void_v<result_t>, types<>, types<std::decay_t<result_t>>>;
+    };
+
+    template<typename S, typename F>
+    class ThenSender {
+    public:
+
+        using sender_concept = sender_t;
+        using value_types = typename ThenValueTypes<F, value_types_of_t<S>>::type;
+
+        ThenSender(S&& sndr, F&& fn);
+
+        template<receiver R>
+        auto connect(R&& rcvr) &&;
+
+    private:
+
+        S sndr_;
+        F fn_;
+
+    };
+
+    template<typename F>
+    struct ThenClosure {
+        F fn;
+    };
+
+    template<sender S, typename F>
+    ThenSender<std::remove_cvref_t<S>, std::decay_t<F>> then(S&& sndr, F&& fn);
+
+    template<typename F>
+    ThenClosure<std::decay_t<F>> then(F&& fn);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // bulk
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // fn(index, values&...) is called for every index in [0, shape). When the
+    // predecessor completes on a ThreadPool worker the range is split into
+    // chunks queued on that pool; elsewhere it runs inline.
+
+    template<typename S, typename Shape, typename F, typename R>
+    class BulkOperation {
+    public:
+
+        BulkOperation(const BulkOperation&) = delete;
+        BulkOperation& operator=(const BulkOperation&) = delete;
+
+    public:
+
+        using operation_state_concept = operation_state_t;
+
+        static constexpr std::size_t MAX_CHUNKS{ 64 };
+
+        BulkOperation(S&& sndr, Shape shape, F&& fn, R&& rcvr);
+
+        void start() noexcept;
+
+    private:
+
+        template<typename Types>
+        struct ValuesOf;
+
+        template<typename... Ts>
+        struct ValuesOf<types<Ts...>> {
+            using type = std::tuple<Ts...>;
+        };
+
+        using values_t = typename ValuesOf<value_types_of_t<S>>::type;
+
+        class Receiver {
+        public:
+
+            using receiver_concept = receiver_t;
+
+            explicit Receiver(BulkOperation* operation) noexcept;
+
+            template<typename... Vs>
+            void set_value(Vs&&... values) && noexcept;
+            void set_error(std::exception_ptr error) && noexcept;
+            void set_stopped() && noexcept;
+
+        private:
+
+            BulkOperation* operation_;
+
+        };
+
+        class Chunk : private OperationBase {
+        public:
+
+            Chunk() noexcept;
+
+            void Submit(BulkOperation* operation, ThreadPool& pool, const Shape begin, const Shape end) noexcept;
+
+        private:
+
+            BulkOperation* operation_;
+            Shape begin_;
+            Shape end_;
+
+            static void Execute_(OperationBase* base) noexcept;
+
+        };
+
+        Shape shape_;
+        F fn_;
+        R rcvr_;
+        std::optional<values_t> values_;
+        std::atomic<std::size_t> remaining_;
+        std::atomic_bool failed_;
+        std::exception_ptr error_;
+        Chunk chunks_[MAX_CHUNKS];
+        connect_result_t<S, Receiver> operation_;
+
+        void Run_(const Shape begin, const Shape end) noexcept;
+        void Finish_() noexcept;
+
+    };
+
+    template<typename S, typename Shape, typename F>
+    class BulkSender {
+    public:
+
+        using sender_concept = sender_t;
+        using value_types = value_types_of_t<S>;
+
+        BulkSender(S&& sndr, Shape shape, F&& fn);
+
+        template<receiver R>
+        BulkOperation<S, Shape, F, std::remove_cvref_t<R>> connect(R&& rcvr) &&;
+
+    private:
+
+        S sndr_;
+        Shape shape_;
+        F fn_;
+
+    };
+
+    template<typename Shape, typename F>
+    struct BulkClosure {
+        Shape shape;
+        F fn;
+    };
+
+    template<sender S, std::integral Shape, typename F>
+    BulkSender<std::remove_cvref_t<S>, Shape, std::decay_t<F>> bulk(S&& sndr, Shape shape, F&& fn);
+
+    template<std::integral Shape, typename F>
+    BulkClosure<Shape, std::decay_t<F>> bulk(Shape shape, F&& fn);
+
+    template<sender S, typename F>
+    auto operator|(S&& sndr, ThenClosure<F> closure);
+
+    template<sender S, typename Shape, typename F>
+    auto operator|(S&& sndr, BulkClosure<Shape, F> closure);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // sync_wait
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Blocks the calling thread; do not call it from the only worker of a pool
+    // the sender completes on.
+
+    template<sender S>
+    auto sync_wait(S&& sndr);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ScheduleOperation class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename R>
+    inline ScheduleOperation<R>::ScheduleOperation(ThreadPool& pool, R&& rcvr) :
+        OperationBase(&ScheduleOperation::Execute_),
+        pool_{ pool },
+        rcvr_{ std::move(rcvr) }
+    {}
+
+    template<typename R>
+    inline void ScheduleOperation<R>::start() noexcept {
+        Enqueue_(pool_, *this);
+    }
+
+    template<typename R>
+    inline void ScheduleOperation<R>::Execute_(OperationBase* base) noexcept {
+        ScheduleOperation& self = *static_cast<ScheduleOperation*>(base);
+        exec::set_value(std::move(self.rcvr_));
+    }
+
+    template<receiver R>
+    inline ScheduleOperation<std::remove_cvref_t<R>> ScheduleSender::connect(R&& rcvr) const {
+        return ScheduleOperation<std::remove_cvref_t<R>>(*pool_, std::remove_cvref_t<R>(std::forward<R>(rcvr)));
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // just defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename R, typename... Ts>
+    inline JustOperation<R, Ts...>::JustOperation(R&& rcvr, std::tuple<Ts...>&& values) :
+        rcvr_{ std::move(rcvr) },
+        values_{ std::move(values) }
+    {}
+
+    template<typename R, typename... Ts>
+    inline void JustOperation<R, Ts...>::start() noexcept {
+        std::apply([this](Ts&... values) {
+            exec::set_value(std::move(rcvr_), std::move(values)...);
+        }, values_);
+    }
+
+    template<typename... Ts>
+    inline JustSender<Ts...>::JustSender(Ts... values) :
+        values_{ std::move(values)... }
+    {}
+
+    template<typename... Ts>
+    template<receiver R>
+    inline JustOperation<std::remove_cvref_t<R>, Ts...> JustSender<Ts...>::connect(R&& rcvr) && {
+        return JustOperation<std::remove_cvref_t<R>, Ts...>(std::remove_cvref_t<R>(std::forward<R>(rcvr)), std::move(values_));
+    }
+
+    template<typename... Vs>
+    inline JustSender<std::decay_t<Vs>...> just(Vs&&... values) {
+        return JustSender<std::decay_t<Vs>...>(std::forward<Vs>(values)...);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // then defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename R, typename F>
+    inline ThenReceiver<R, F>::ThenReceiver(R&& rcvr, F&& fn) :
+        rcvr_{ std::move(rcvr) },
+        fn_{ std::move(fn) }
+    {}
+
+    template<typename R, typename F>
+    template<typename... Vs>
+    inline void ThenReceiver<R, F>::set_value(Vs&&... values) && noexcept {
+        try {
+            if constexpr (std::is_void_v<std::invoke_result_t<F, Vs...>>) {
+                std::invoke(fn_, std::forward<Vs>(values)...);
+                exec::set_value(std::move(rcvr_));
+            }
+            else {
+                exec::set_value(std::move(rcvr_), std::invoke(fn_, std::forward<Vs>(values)...));
+            }
+        }
+        catch (...) {
+            exec::set_error(std::move(rcvr_), std::current_exception());
+        }
+    }
+
+    template<typename R, typename F>
+    inline void ThenReceiver<R, F>::set_error(std::exception_ptr error) && noexcept {
+        exec::set_error(std::move(rcvr_), std::move(error));
+    }
+
+    template<typename R, typename F>
+    inline void ThenReceiver<R, F>::set_stopped() && noexcept {
+        exec::set_stopped(std::move(rcvr_));
+    }
+
+    template<typename S, typename F>
+    inline ThenSender<S, F>::ThenSender(S&& sndr, F&& fn) :
+        sndr_{ std::move(sndr) },
+        fn_{ std::move(fn) }
+    {}
+
+    template<typename S, typename F>
+    template<receiver R>
+    inline auto ThenSender<S, F>::connect(R&& rcvr) && {
+        using rcvr_t = std::remove_cvref_t<R>;
+        return exec::connect(std::move(sndr_), ThenReceiver<rcvr_t, F>(rcvr_t(std::forward<R>(rcvr)), std::move(fn_)));
+    }
+
+    template<sender S, typename F>
+    inline ThenSender<std::remove_cvref_t<S>, std::decay_t<F>> then(S&& sndr, F&& fn) {
+        return ThenSender<std::remove_cvref_t<S>, std::decay_t<F>>(std::remove_cvref_t<S>(std::forward<S>(sndr)), std::decay_t<F>(std::forward<F>(fn)));
+    }
+
+    template<typename F>
+    inline ThenClosure<std::decay_t<F>> then(F&& fn) {
+        return ThenClosure<std::decay_t<F>>{ std::forward<F>(fn) };
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // bulk defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline BulkOperation<S, Shape, F, R>::BulkOperation(S&& sndr, Shape shape, F&& fn, R&& rcvr) :
+        shape_{ shape },
+        fn_{ std::move(fn) },
+        rcvr_{ std::move(rcvr) },
+        values_{ },
+        remaining_{ 0 },
+        failed_{ false },
+        error_{ },
+        chunks_{ },
+        operation_{ exec::connect(std::move(sndr), Receiver(this)) }
+    {}
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline void BulkOperation<S, Shape, F, R>::start() noexcept {
+        exec::start(operation_);
+    }
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline void BulkOperation<S, Shape, F, R>::Run_(const Shape begin, const Shape end) noexcept {
+        try {
+            for (Shape index = begin; index < end && !failed_.load(std::memory_order_relaxed); ++index) {
+                std::apply([this, index](auto&... values) {
+                    std::invoke(fn_, index, values...);
+                }, *values_);
+            }
+        }
+        catch (...) {
+            if (!failed_.exchange(true)) {
+                error_ = std::current_exception();
+            }
+        }
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Finish_();
+        }
+    }
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline void BulkOperation<S, Shape, F, R>::Finish_() noexcept {
+        if (failed_.load(std::memory_order_acquire)) {
+            exec::set_error(std::move(rcvr_), std::move(error_));
+            return;
+        }
+        std::apply([this](auto&... values) {
+            exec::set_value(std::move(rcvr_), std::move(values)...);
+        }, *values_);
+    }
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline BulkOperation<S, Shape, F, R>::Receiver::Receiver(BulkOperation* operation) noexcept :
+        operation_{ operation }
+    {}
+
+    template<typename S, typename Shape, typename F, typename R>
+    template<typename... Vs>
+    inline void BulkOperation<S, Shape, F, R>::Receiver::set_value(Vs&&... values) && noexcept {
+        BulkOperation& self = *operation_;
+        try {
+            self.values_.emplace(std::forward<Vs>(values)...);
+        }
+        catch (...) {
+            exec::set_error(std::move(self.rcvr_), std::current_exception());
+            return;
+        }
+
+        WorkerContext* const worker = ThreadPool::CurrentWorker();
+        ThreadPool* const pool = worker ? worker->Pool() : nullptr;
+        const std::size_t shape = self.shape_ > 0 ? static_cast<std::size_t>(self.shape_) : 0;
+        std::size_t chunks = pool ? std::min({ shape, pool->ThreadsCount(), MAX_CHUNKS }) : 1;
+        chunks = std::max<std::size_t>(chunks, 1);
+        self.remaining_.store(chunks, std::memory_order_relaxed);
+
+        // The current worker takes the first chunk itself.
+        const std::size_t step = shape / chunks;
+        const std::size_t extra = shape % chunks;
+        Shape first_end{ static_cast<Shape>(step + (extra > 0 ? 1 : 0)) };
+        Shape begin{ first_end };
+        for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+            const Shape end = static_cast<Shape>(begin + static_cast<Shape>(step + (chunk < extra ? 1 : 0)));
+            self.chunks_[chunk].Submit(&self, *pool, begin, end);
+            begin = end;
+        }
+        self.Run_(Shape{ 0 }, first_end);
+    }
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline void BulkOperation<S, Shape, F, R>::Receiver::set_error(std::exception_ptr error) && noexcept {
+        exec::set_error(std::move(operation_->rcvr_), std::move(error));
+    }
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline void BulkOperation<S, Shape, F, R>::Receiver::set_stopped() && noexcept {
+        exec::set_stopped(std::move(operation_->rcvr_));
+    }
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline BulkOperation<S, Shape, F, R>::Chunk::Chunk() noexcept :
+        OperationBase(&Chunk::Execute_),
+        operation_{ nullptr },
+        begin_{ },
+        end_{ }
+    {}
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline void BulkOperation<S, Shape, F, R>::Chunk::Submit(BulkOperation* operation, ThreadPool& pool, const Shape begin, const Shape end) noexcept {
+        operation_ = operation;
+        begin_ = begin;
+        end_ = end;
+        Enqueue_(pool, *this);
+    }
+
+    template<typename S, typename Shape, typename F, typename R>
+    inline void BulkOperation<S, Shape, F, R>::Chunk::Execute_(OperationBase* base) noexcept {
+        Chunk& self = *static_cast<Chunk*>(base);
+        self.operation_->Run_(self.begin_, self.end_);
+    }
+
+    template<typename S, typename Shape, typename F>
+    inline BulkSender<S, Shape, F>::BulkSender(S&& sndr, Shape shape, F&& fn) :
+        sndr_{ std::move(sndr) },
+        shape_{ shape },
+        fn_{ std::move(fn) }
+    {}
+
+    template<typename S, typename Shape, typename F>
+    template<receiver R>
+    inline BulkOperation<S, Shape, F, std::remove_cvref_t<R>> BulkSender<S, Shape, F>::connect(R&& rcvr) && {
+        using rcvr_t = std::remove_cvref_t<R>;
+        return BulkOperation<S, Shape, F, rcvr_t>(std::move(sndr_), shape_, std::move(fn_), rcvr_t(std::forward<R>(rcvr)));
+    }
+
+    template<sender S, std::integral Shape, typename F>
+    inline BulkSender<std::remove_cvref_t<S>, Shape, std::decay_t<F>> bulk(S&& sndr, Shape shape, F&& fn) {
+        return BulkSender<std::remove_cvref_t<S>, Shape, std::decay_t<F>>(std::remove_cvref_t<S>(std::forward<S>(sndr)), shape, std::decay_t<F>(std::forward<F>(fn)));
+    }
+
+    template<std::integral Shape, typename F>
+    inline BulkClosure<Shape, std::decay_t<F>> bulk(Shape shape, F&& fn) {
+        return BulkClosure<Shape, std::decay_t<F>>{ shape, std::forward<F>(fn) };
+    }
+
+    template<sender S, typename F>
+    inline auto operator|(S&& sndr, ThenClosure<F> closure) {
+        return exec::then(std::forward<S>(sndr), std::move(closure.fn));
+    }
+
+    template<sender S, typename Shape, typename F>
+    inline auto operator|(S&& sndr, BulkClosure<Shape, F> closure) {
+        return exec::bulk(std::forward<S>(sndr), closure.shape, std::move(closure.fn));
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // sync_wait defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename Types>
+    struct SyncWaitState;
+
+    template<typename... Ts>
+    struct SyncWaitState<types<Ts...>> {
+        std::mutex mtx;
+        std::condition_variable done_cv;
+        bool done{ false };
+        std::optional<std::tuple<Ts...>> result;
+        std::exception_ptr error;
+
+        class Receiver {
+        public:
+
+            using receiver_concept = receiver_t;
+
+            explicit Receiver(SyncWaitState* state) noexcept :
+                state_{ state }
+            {}
+
+            template<typename... Vs>
+            void set_value(Vs&&... values) && noexcept {
+                try {
+                    state_->result.emplace(std::forward<Vs>(values)...);
+                }
+                catch (...) {
+                    state_->error = std::current_exception();
+                }
+                Signal_();
+            }
+
+            void set_error(std::exception_ptr error) && noexcept {
+                state_->error = std::move(error);
+                Signal_();
+            }
+
+            void set_stopped() && noexcept {
+                Signal_();
+            }
+
+        private:
+
+            SyncWaitState* state_;
+
+            void Signal_() noexcept {
+                const std::scoped_lock done_lock(state_->mtx);
+                state_->done = true;
+                state_->done_cv.notify_all();
+            }
+
+        };
+    };
+
+    template<sender S>
+    inline auto sync_wait(S&& sndr) {
+        using state_t = SyncWaitState<value_types_of_t<S>>;
+        state_t state;
+        auto operation = exec::connect(std::forward<S>(sndr), typename state_t::Receiver(&state));
+        exec::start(operation);
+        std::unique_lock done_lock(state.mtx);
+        state.done_cv.wait(done_lock, [&state] { return state.done; });
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+        return std::move(state.result);
+    }
+
+}
+
+#endif // INCLUDE_GUARD_SCHEDULER_HPP
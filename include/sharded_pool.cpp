@@ -0,0 +1,265 @@
+#include <sharded_pool.hpp>
+
+#include <utility>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+namespace vsock {
+
+    namespace {
+
+        thread_local const ShardedPool* current_pool{ nullptr };
+        thread_local std::size_t current_shard{ ShardedPool::NO_SHARD };
+
+        constexpr int IDLE_SPINS{ 64 };
+
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ShardedPool class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ShardedPool::ShardedPool() :
+        ShardedPool(std::thread::hardware_concurrency())
+    {}
+
+    ShardedPool::ShardedPool(const std::size_t shards) :
+        shards_count_{ shards > 0 ? shards : 1 },
+        shards_{ std::make_unique<Shard[]>(shards_count_) },
+        cpus_{ },
+        working_{ true },
+        next_shard_{ 0 },
+        waiters_{ 0 },
+        idle_signal_{ 0 }
+    {
+        for (std::size_t index = 0; index < shards_count_; ++index) {
+            Shard& shard = shards_[index];
+            shard.context.index_ = index;
+            shard.mailboxes = std::make_unique<std::unique_ptr<SpscQueue<Task*>>[]>(shards_count_);
+            for (std::size_t from = 0; from < shards_count_; ++from) {
+                if (from != index) {
+                    shard.mailboxes[from] = std::make_unique<SpscQueue<Task*>>(MAILBOX_CAPACITY);
+                }
+            }
+        }
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (::sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    cpus_.push_back(cpu);
+                }
+            }
+        }
+#endif
+        for (std::size_t index = 0; index < shards_count_; ++index) {
+            shards_[index].thread = std::thread(&ShardedPool::Process_, this, index);
+        }
+    }
+
+    ShardedPool::~ShardedPool() {
+        Wait();
+        working_.store(false);
+        for (std::size_t index = 0; index < shards_count_; ++index) {
+            shards_[index].signal.fetch_add(1);
+            shards_[index].signal.notify_one();
+        }
+        for (std::size_t index = 0; index < shards_count_; ++index) {
+            shards_[index].thread.join();
+        }
+    }
+
+    std::size_t ShardedPool::Shards() const noexcept {
+        return shards_count_;
+    }
+
+    std::size_t ShardedPool::CurrentShard() const noexcept {
+        return current_pool == this ? current_shard : NO_SHARD;
+    }
+
+    void ShardedPool::Wait() noexcept {
+        waiters_.fetch_add(1);
+        while (true) {
+            const std::uint32_t observed = idle_signal_.load();
+            if (Quiescent_()) {
+                break;
+            }
+            idle_signal_.wait(observed);
+        }
+        waiters_.fetch_sub(1);
+    }
+
+    void ShardedPool::AddSyncTask(std::unique_ptr<Task> task) {
+        Route_(PickShard_(), std::move(task));
+    }
+
+    void ShardedPool::AddAsyncTask(std::unique_ptr<Task> task) {
+        Route_(PickShard_(), std::move(task));
+    }
+
+    void ShardedPool::AddAsyncTaskTo(const std::size_t shard, std::unique_ptr<Task> task) {
+        Route_(shard, std::move(task));
+    }
+
+    std::unique_ptr<Task> ShardedPool::CreateTask_(const std::size_t shard) {
+        // The payload and promise state stay on the default resource, since
+        // a future may outlive the pool.
+        std::pmr::memory_resource* resource = &shards_[shard % shards_count_].resource;
+        return std::unique_ptr<Task>(new (resource) Task());
+    }
+
+    void ShardedPool::Route_(const std::size_t shard, std::unique_ptr<Task>&& task) {
+        const std::size_t to = shard % shards_count_;
+        const std::size_t from = CurrentShard();
+        Shard& target = shards_[to];
+        target.submitted.fetch_add(1);
+
+        if (from == to) {
+            target.local.push_back(std::move(task));
+            return;
+        }
+        if (from != NO_SHARD) {
+            Task* raw = task.get();
+            if (target.mailboxes[from]->TryPush(std::move(raw))) {
+                static_cast<void>(task.release());
+                Wake_(target);
+                return;
+            }
+        }
+        {
+            const std::scoped_lock external_lock(target.external_mutex);
+            target.external.push_back(std::move(task));
+            target.external_count.fetch_add(1);
+        }
+        Wake_(target);
+    }
+
+    std::size_t ShardedPool::PickShard_() noexcept {
+        const std::size_t shard = CurrentShard();
+        if (shard != NO_SHARD) {
+            return shard;
+        }
+        return next_shard_.fetch_add(1, std::memory_order_relaxed) % shards_count_;
+    }
+
+    bool ShardedPool::Collect_(Shard& shard) {
+        bool collected{ false };
+        Task* raw{ nullptr };
+        for (std::size_t from = 0; from < shards_count_; ++from) {
+            if (!shard.mailboxes[from]) {
+                continue;
+            }
+            while (shard.mailboxes[from]->TryPop(raw)) {
+                shard.local.emplace_back(raw);
+                collected = true;
+            }
+        }
+        if (shard.external_count.load(std::memory_order_acquire) > 0) {
+            const std::scoped_lock external_lock(shard.external_mutex);
+            while (!shard.external.empty()) {
+                shard.local.push_back(std::move(shard.external.front()));
+                shard.external.pop_front();
+            }
+            shard.external_count.store(0, std::memory_order_relaxed);
+            collected = true;
+        }
+        return collected;
+    }
+
+    bool ShardedPool::Quiescent_() const noexcept {
+        std::uint64_t completed{ 0 };
+        std::uint64_t submitted{ 0 };
+        for (std::size_t index = 0; index < shards_count_; ++index) {
+            completed += shards_[index].completed.load();
+        }
+        for (std::size_t index = 0; index < shards_count_; ++index) {
+            submitted += shards_[index].submitted.load();
+        }
+        return completed == submitted;
+    }
+
+    void ShardedPool::Wake_(Shard& shard) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (shard.sleeping.load()) {
+            shard.signal.fetch_add(1);
+            shard.signal.notify_one();
+        }
+    }
+
+    void ShardedPool::Pin_(const std::size_t index) noexcept {
+#if defined(__linux__)
+        // Shards cycle over the CPUs the process may run on, so a restricted
+        // cpuset (taskset, containers) never pins a shard outside of it.
+        if (cpus_.empty()) {
+            return;
+        }
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpus_[index % cpus_.size()], &cpu_set);
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set);
+#else
+        static_cast<void>(index);
+#endif
+    }
+
+    void ShardedPool::Process_(const std::size_t index) {
+        Shard& shard = shards_[index];
+        Pin_(index);
+        current_pool = this;
+        current_shard = index;
+        WorkerContext::current_ = &shard.context;
+
+        while (true) {
+            Collect_(shard);
+
+            if (!shard.local.empty()) {
+                for (std::size_t count = shard.local.size(); count > 0; --count) {
+                    std::unique_ptr<Task> task = std::move(shard.local.front());
+                    shard.local.pop_front();
+                    const bool not_finished = (*task)();
+                    shard.context.scratch_.Reset();
+                    if (not_finished) {
+                        shard.local.push_back(std::move(task));
+                    }
+                    else {
+                        shard.completed.fetch_add(1);
+                    }
+                }
+                continue;
+            }
+
+            if (waiters_.load() > 0) {
+                idle_signal_.fetch_add(1);
+                idle_signal_.notify_all();
+            }
+            if (!working_.load(std::memory_order_acquire)) {
+                break;
+            }
+
+            bool pending{ false };
+            for (int spin = 0; spin < IDLE_SPINS && !pending; ++spin) {
+                pending = Collect_(shard);
+            }
+            if (pending) {
+                continue;
+            }
+
+            const std::uint32_t observed = shard.signal.load();
+            shard.sleeping.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!Collect_(shard) && working_.load()) {
+                shard.signal.wait(observed);
+            }
+            shard.sleeping.store(false, std::memory_order_relaxed);
+        }
+
+        WorkerContext::current_ = nullptr;
+        current_shard = NO_SHARD;
+        current_pool = nullptr;
+    }
+
+}
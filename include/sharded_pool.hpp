@@ -0,0 +1,134 @@
+#ifndef INCLUDE_GUARD_SHARDED_POOL_HPP
+#define INCLUDE_GUARD_SHARDED_POOL_HPP
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+
+#include <task.hpp>
+#include <spsc.hpp>
+#include <worker.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ShardedPool class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class ShardedPool {
+    public:
+
+        ShardedPool(ShardedPool&&) = delete;
+        ShardedPool& operator=(ShardedPool&&) = delete;
+
+    public:
+
+        static constexpr std::size_t NO_SHARD{ std::numeric_limits<std::size_t>::max() };
+        static constexpr std::size_t MAILBOX_CAPACITY{ 256 };
+
+        ShardedPool();
+        ShardedPool(const std::size_t shards);
+        ~ShardedPool();
+
+        std::size_t Shards() const noexcept;
+        std::size_t CurrentShard() const noexcept;
+
+        void Wait() noexcept;
+
+        void AddSyncTask(std::unique_ptr<Task> task);
+        void AddAsyncTask(std::unique_ptr<Task> task);
+        void AddAsyncTaskTo(const std::size_t shard, std::unique_ptr<Task> task);
+
+        template<typename F, typename...Args>
+        auto AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
+
+        template<typename F, typename...Args>
+        void AddAsyncTask(F&& job, Args&&... args);
+
+        template<typename F, typename...Args>
+        auto AddSyncTaskTo(const std::size_t shard, F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
+
+        template<typename F, typename...Args>
+        void AddAsyncTaskTo(const std::size_t shard, F&& job, Args&&... args);
+
+    private:
+
+        struct alignas(CACHE_LINE_SIZE) Shard {
+            std::thread thread;
+            WorkerContext context;
+            // Serves the Task nodes routed to this shard. Other threads
+            // allocate from it when they submit, hence the synchronized pool.
+            std::pmr::synchronized_pool_resource resource;
+            std::deque<std::unique_ptr<Task>> local;
+            std::unique_ptr<std::unique_ptr<SpscQueue<Task*>>[]> mailboxes;
+
+            std::mutex external_mutex;
+            std::deque<std::unique_ptr<Task>> external;
+            std::atomic<std::size_t> external_count{ 0 };
+
+            alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> signal{ 0 };
+            std::atomic_bool sleeping{ false };
+
+            alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> submitted{ 0 };
+            alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> completed{ 0 };
+        };
+
+        std::size_t shards_count_;
+        std::unique_ptr<Shard[]> shards_;
+        std::vector<int> cpus_;
+        std::atomic_bool working_;
+        std::atomic<std::size_t> next_shard_;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> waiters_;
+        std::atomic<std::uint32_t> idle_signal_;
+
+        std::unique_ptr<Task> CreateTask_(const std::size_t shard);
+        void Route_(const std::size_t shard, std::unique_ptr<Task>&& task);
+        std::size_t PickShard_() noexcept;
+        bool Collect_(Shard& shard);
+        bool Quiescent_() const noexcept;
+        void Wake_(Shard& shard) noexcept;
+        void Pin_(const std::size_t index) noexcept;
+        void Process_(const std::size_t index);
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ShardedPool class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename F, typename...Args>
+    auto ShardedPool::AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        return AddSyncTaskTo(PickShard_(), std::forward<F>(job), std::forward<Args>(args)...);
+    }
+
+    template<typename F, typename...Args>
+    void ShardedPool::AddAsyncTask(F&& job, Args&&... args) {
+        AddAsyncTaskTo(PickShard_(), std::forward<F>(job), std::forward<Args>(args)...);
+    }
+
+    template<typename F, typename...Args>
+    auto ShardedPool::AddSyncTaskTo(const std::size_t shard, F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        std::unique_ptr<Task> task_ptr(CreateTask_(shard));
+        auto result = task_ptr->SetSyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        Route_(shard, std::move(task_ptr));
+        return result;
+    }
+
+    template<typename F, typename...Args>
+    void ShardedPool::AddAsyncTaskTo(const std::size_t shard, F&& job, Args&&... args) {
+        std::unique_ptr<Task> task_ptr(CreateTask_(shard));
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        Route_(shard, std::move(task_ptr));
+    }
+
+}
+
+#endif // INCLUDE_GUARD_SHARDED_POOL_HPP
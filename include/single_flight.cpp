@@ -0,0 +1,80 @@
+#include <single_flight.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FlightKey class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    std::size_t FlightKey::Hash() const noexcept {
+        return hash_;
+    }
+
+    bool FlightKey::operator==(const FlightKey& rhs) const noexcept {
+        return type_ == rhs.type_ && hash_ == rhs.hash_ && equal_(value_.get(), rhs.value_.get());
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SingleFlight class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    SingleFlight::SingleFlight(const std::size_t capacity, const std::chrono::milliseconds ttl) :
+        SingleFlight(capacity, ttl, std::pmr::get_default_resource())
+    {}
+
+    SingleFlight::SingleFlight(const std::size_t capacity, const std::chrono::milliseconds ttl, std::pmr::memory_resource* resource) :
+        capacity_{ capacity },
+        ttl_{ ttl },
+        resource_{ resource },
+        mutex_{ },
+        flights_{ resource },
+        landed_{ resource }
+    {}
+
+    void SingleFlight::Land(const FlightKey& key, const bool succeeded) noexcept {
+        const std::scoped_lock flights_lock(mutex_);
+        const auto flight = flights_.find(key);
+        if (flight == flights_.end() || flight->second.landed) {
+            return;
+        }
+        if (!succeeded || capacity_ == 0) {
+            Erase_(flight);
+            return;
+        }
+        try {
+            flight->second.lru = landed_.insert(landed_.begin(), key);
+        }
+        catch (...) {
+            Erase_(flight);
+            return;
+        }
+        flight->second.landed = true;
+        flight->second.expires = clock_t::now() + ttl_;
+        while (landed_.size() > capacity_) {
+            Erase_(flights_.find(landed_.back()));
+        }
+    }
+
+    void SingleFlight::Clear() noexcept {
+        const std::scoped_lock flights_lock(mutex_);
+        flights_.clear();
+        landed_.clear();
+    }
+
+    std::size_t SingleFlight::Size() const {
+        const std::scoped_lock flights_lock(mutex_);
+        return flights_.size();
+    }
+
+    std::size_t SingleFlight::KeyHash::operator()(const FlightKey& key) const noexcept {
+        return key.Hash();
+    }
+
+    void SingleFlight::Erase_(const flights_t::iterator flight) noexcept {
+        if (flight->second.landed) {
+            landed_.erase(flight->second.lru);
+        }
+        flights_.erase(flight);
+    }
+
+}
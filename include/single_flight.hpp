@@ -0,0 +1,183 @@
+#ifndef INCLUDE_GUARD_SINGLE_FLIGHT_HPP
+#define INCLUDE_GUARD_SINGLE_FLIGHT_HPP
+
+#include <list>
+#include <mutex>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <stdexcept>
+#include <typeindex>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <memory_resource>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FlightKey class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Type-erased copy of a user key: needs std::hash and operator==. String
+    // like keys are stored as std::pmr::string so literals compare by content.
+
+    class FlightKey {
+    public:
+
+        template<typename K>
+        explicit FlightKey(const K& key);
+
+        template<typename K>
+        FlightKey(const K& key, std::pmr::memory_resource* resource);
+
+        std::size_t Hash() const noexcept;
+        bool operator==(const FlightKey& rhs) const noexcept;
+
+    private:
+
+        using equal_t = bool (*)(const void*, const void*) noexcept;
+
+        std::shared_ptr<const void> value_;
+        std::type_index type_;
+        std::size_t hash_;
+        equal_t equal_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SingleFlight class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Deduplicates identical in-flight computations: Join() starts the work
+    // only when no flight with that key exists and otherwise hands out the
+    // same shared future. Landed results stay in a bounded LRU for ttl when
+    // capacity > 0 (ttl 0 keeps them until evicted); failures are never kept.
+
+    class SingleFlight {
+    public:
+
+        SingleFlight(const SingleFlight&) = delete;
+        SingleFlight& operator=(const SingleFlight&) = delete;
+
+    public:
+
+        SingleFlight(const std::size_t capacity, const std::chrono::milliseconds ttl);
+        SingleFlight(const std::size_t capacity, const std::chrono::milliseconds ttl, std::pmr::memory_resource* resource);
+
+        // start() must return std::future<R> for work that calls Land(key)
+        // once its future is ready; it runs under the table lock.
+        template<typename R, typename Start>
+        std::shared_future<R> Join(const FlightKey& key, Start&& start);
+
+        void Land(const FlightKey& key, const bool succeeded) noexcept;
+        void Clear() noexcept;
+        std::size_t Size() const;
+
+    private:
+
+        using clock_t = std::chrono::steady_clock;
+
+        struct Flight {
+            std::shared_ptr<void> future;
+            std::type_index type;
+            bool landed;
+            clock_t::time_point expires;
+            std::pmr::list<FlightKey>::iterator lru;
+        };
+
+        struct KeyHash {
+            std::size_t operator()(const FlightKey& key) const noexcept;
+        };
+
+        using flights_t = std::pmr::unordered_map<FlightKey, Flight, KeyHash>;
+
+        const std::size_t capacity_;
+        const std::chrono::milliseconds ttl_;
+        std::pmr::memory_resource* resource_;
+        mutable std::mutex mutex_;
+        flights_t flights_;
+        std::pmr::list<FlightKey> landed_;
+
+        // Expects mutex_ to be held.
+        void Erase_(const flights_t::iterator flight) noexcept;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FlightKey class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename K>
+    inline FlightKey::FlightKey(const K& key) :
+        FlightKey(key, std::pmr::get_default_resource())
+    {}
+
+    template<typename K>
+    inline FlightKey::FlightKey(const K& key, std::pmr::memory_resource* resource) :
+        value_{ },
+        type_{ typeid(void) },
+        hash_{ 0 },
+        equal_{ nullptr }
+    {
+        constexpr bool is_string = std::is_convertible_v<const K&, std::string_view>;
+        using value_t = std::conditional_t<is_string, std::pmr::string, K>;
+        const std::pmr::polymorphic_allocator<value_t> allocator(resource);
+        std::shared_ptr<value_t> value;
+        if constexpr (is_string) {
+            value = std::allocate_shared<value_t>(allocator, std::string_view(key));
+        }
+        else {
+            value = std::allocate_shared<value_t>(allocator, key);
+        }
+        type_ = typeid(value_t);
+        hash_ = std::hash<value_t>{}(*value);
+        equal_ = [](const void* lhs, const void* rhs) noexcept {
+            return *static_cast<const value_t*>(lhs) == *static_cast<const value_t*>(rhs);
+        };
+        value_ = std::move(value);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SingleFlight class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename R, typename Start>
+    inline std::shared_future<R> SingleFlight::Join(const FlightKey& key, Start&& start) {
+        const std::scoped_lock flights_lock(mutex_);
+        if (auto flight = flights_.find(key); flight != flights_.end()) {
+            if (flight->second.type != typeid(R)) {
+                throw std::runtime_error("key is already in flight with another result type");
+            }
+            std::shared_future<R>& future = *std::static_pointer_cast<std::shared_future<R>>(flight->second.future);
+            const bool expired = flight->second.landed && ttl_.count() > 0 && clock_t::now() > flight->second.expires;
+            // Ready but not landed yet: a value is final and can be shared, an
+            // error means the work failed or was dropped before it ran.
+            bool abandoned{ false };
+            if (!flight->second.landed && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                try {
+                    future.get();
+                }
+                catch (...) {
+                    abandoned = true;
+                }
+            }
+            if (!expired && !abandoned) {
+                if (flight->second.landed) {
+                    landed_.splice(landed_.begin(), landed_, flight->second.lru);
+                }
+                return future;
+            }
+            Erase_(flight);
+        }
+        auto future = std::allocate_shared<std::shared_future<R>>(std::pmr::polymorphic_allocator<std::shared_future<R>>(resource_), std::forward<Start>(start)().share());
+        std::shared_future<R> result = *future;
+        flights_.emplace(key, Flight{ std::move(future), typeid(R), false, clock_t::time_point{}, landed_.end() });
+        return result;
+    }
+
+}
+
+#endif // INCLUDE_GUARD_SINGLE_FLIGHT_HPP
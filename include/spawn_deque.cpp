@@ -0,0 +1,65 @@
+#include <spawn_deque.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpawnDeque class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    SpawnDeque::SpawnDeque() noexcept :
+        top_{ 0 },
+        bottom_{ 0 },
+        slots_{ }
+    {}
+
+    bool SpawnDeque::Push(SpawnFrame* frame) noexcept {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t top = top_.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<std::int64_t>(CAPACITY)) {
+            return false;
+        }
+        slots_[static_cast<std::size_t>(bottom) & (CAPACITY - 1)].store(frame, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    SpawnFrame* SpawnDeque::Pop() noexcept {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        SpawnFrame* frame = slots_[static_cast<std::size_t>(bottom) & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last entry: race the thieves for it.
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                frame = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return frame;
+    }
+
+    SpawnFrame* SpawnDeque::Steal() noexcept {
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        SpawnFrame* frame = slots_[static_cast<std::size_t>(top) & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return frame;
+    }
+
+    bool SpawnDeque::Empty() const noexcept {
+        return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+    }
+
+}
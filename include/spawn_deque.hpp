@@ -0,0 +1,51 @@
+#ifndef INCLUDE_GUARD_SPAWN_DEQUE_HPP
+#define INCLUDE_GUARD_SPAWN_DEQUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include <spsc.hpp>
+
+namespace vsock {
+
+    class SpawnFrame;
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpawnDeque class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Chase-Lev work-stealing deque of fixed capacity: the owning worker pushes
+    // and pops at the bottom, other workers steal from the top.
+
+    class SpawnDeque {
+    public:
+
+        SpawnDeque(const SpawnDeque&) = delete;
+        SpawnDeque& operator=(const SpawnDeque&) = delete;
+
+    public:
+
+        static constexpr std::size_t CAPACITY{ 256 };
+
+        SpawnDeque() noexcept;
+
+        bool Push(SpawnFrame* frame) noexcept;
+        SpawnFrame* Pop() noexcept;
+        SpawnFrame* Steal() noexcept;
+        bool Empty() const noexcept;
+
+    private:
+
+        static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> top_;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> bottom_;
+        std::array<std::atomic<SpawnFrame*>, CAPACITY> slots_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_SPAWN_DEQUE_HPP
@@ -0,0 +1,112 @@
+#ifndef INCLUDE_GUARD_SPSC_HPP
+#define INCLUDE_GUARD_SPSC_HPP
+
+#include <new>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <utility>
+
+namespace vsock {
+
+    inline constexpr std::size_t CACHE_LINE_SIZE{ 64 };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpscQueue class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    class SpscQueue {
+    public:
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+    public:
+
+        SpscQueue();
+        SpscQueue(const std::size_t capacity);
+
+        bool TryPush(T&& value) noexcept;
+        bool TryPop(T& value) noexcept;
+        bool Empty() const noexcept;
+
+    private:
+
+        std::unique_ptr<T[]> slots_;
+        std::size_t mask_;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_;
+        std::size_t cached_tail_;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_;
+        std::size_t cached_head_;
+
+        static std::size_t RoundCapacity_(const std::size_t capacity) noexcept;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SpscQueue class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    inline SpscQueue<T>::SpscQueue() :
+        SpscQueue(1024)
+    {}
+
+    template<typename T>
+    inline SpscQueue<T>::SpscQueue(const std::size_t capacity) :
+        slots_{ std::make_unique<T[]>(RoundCapacity_(capacity)) },
+        mask_{ RoundCapacity_(capacity) - 1 },
+        head_{ 0 },
+        cached_tail_{ 0 },
+        tail_{ 0 },
+        cached_head_{ 0 }
+    {}
+
+    template<typename T>
+    inline bool SpscQueue<T>::TryPush(T&& value) noexcept {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T>
+    inline bool SpscQueue<T>::TryPop(T& value) noexcept {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T>
+    inline bool SpscQueue<T>::Empty() const noexcept {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    template<typename T>
+    inline std::size_t SpscQueue<T>::RoundCapacity_(const std::size_t capacity) noexcept {
+        std::size_t result{ 2 };
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+}
+
+#endif // INCLUDE_GUARD_SPSC_HPP
@@ -0,0 +1,96 @@
+#include <strand.hpp>
+
+#include <utility>
+
+namespace vsock {
+
+    namespace {
+
+        thread_local const void* current_strand{ nullptr };
+
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Strand class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Strand::Strand(ThreadPool& pool) :
+        Strand(pool, DEFAULT_BATCH_SIZE)
+    {}
+
+    Strand::Strand(ThreadPool& pool, const std::size_t batch_size) :
+        state_{ std::make_shared<State>(pool, batch_size) }
+    {}
+
+    Strand::State::State(ThreadPool& pool, const std::size_t batch_size) :
+        pool{ pool },
+        batch_size{ batch_size > 0 ? batch_size : 1 },
+        mtx{ },
+        tasks{ pool.Resource() },
+        scheduled{ false }
+    {}
+
+    void Strand::AddSyncTask(std::unique_ptr<Task> task) {
+        Push_(std::move(task));
+    }
+
+    void Strand::AddAsyncTask(std::unique_ptr<Task> task) {
+        Push_(std::move(task));
+    }
+
+    bool Strand::RunningInThisThread() const noexcept {
+        return current_strand == state_.get();
+    }
+
+    std::size_t Strand::Size() const {
+        const std::scoped_lock strand_lock(state_->mtx);
+        return state_->tasks.size();
+    }
+
+    std::unique_ptr<Task> Strand::CreateTask_() const {
+        std::pmr::memory_resource* const resource = state_->pool.Resource();
+        return std::unique_ptr<Task>(new (resource) Task(resource));
+    }
+
+    void Strand::Push_(std::unique_ptr<Task>&& task) {
+        {
+            const std::scoped_lock strand_lock(state_->mtx);
+            state_->tasks.push_back(std::move(task));
+            if (std::exchange(state_->scheduled, true)) {
+                return;
+            }
+        }
+        state_->pool.AddAsyncTask(&Strand::Drain_, state_);
+    }
+
+    void Strand::Drain_(const std::shared_ptr<State>& state) {
+        std::vector<std::unique_ptr<Task>> batch;
+        batch.reserve(state->batch_size);
+        {
+            const std::scoped_lock strand_lock(state->mtx);
+            while (!state->tasks.empty() && batch.size() < state->batch_size) {
+                batch.push_back(std::move(state->tasks.front()));
+                state->tasks.pop_front();
+            }
+        }
+
+        const void* const previous_strand = std::exchange(current_strand, state.get());
+        for (std::unique_ptr<Task>& task : batch) {
+            if ((*task)()) {
+                const std::scoped_lock strand_lock(state->mtx);
+                state->tasks.push_back(std::move(task));
+            }
+        }
+        current_strand = previous_strand;
+
+        {
+            const std::scoped_lock strand_lock(state->mtx);
+            if (state->tasks.empty()) {
+                state->scheduled = false;
+                return;
+            }
+        }
+        state->pool.AddAsyncTask(&Strand::Drain_, state);
+    }
+
+}
@@ -0,0 +1,85 @@
+#ifndef INCLUDE_GUARD_STRAND_HPP
+#define INCLUDE_GUARD_STRAND_HPP
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <memory_resource>
+
+#include <task.hpp>
+#include <threadpool.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Strand class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class Strand {
+    public:
+
+        Strand(const Strand&) = delete;
+        Strand& operator=(const Strand&) = delete;
+
+    public:
+
+        static constexpr std::size_t DEFAULT_BATCH_SIZE{ 16 };
+
+        Strand(ThreadPool& pool);
+        Strand(ThreadPool& pool, const std::size_t batch_size);
+        ~Strand() = default;
+
+        void AddSyncTask(std::unique_ptr<Task> task);
+        void AddAsyncTask(std::unique_ptr<Task> task);
+
+        template<typename F, typename...Args>
+        auto AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
+
+        template<typename F, typename...Args>
+        void AddAsyncTask(F&& job, Args&&... args);
+
+        bool RunningInThisThread() const noexcept;
+        std::size_t Size() const;
+
+    private:
+
+        struct State {
+            State(ThreadPool& pool, const std::size_t batch_size);
+            ThreadPool& pool;
+            const std::size_t batch_size;
+            mutable std::mutex mtx;
+            std::pmr::deque<std::unique_ptr<Task>> tasks;
+            bool scheduled;
+        };
+
+        std::shared_ptr<State> state_;
+
+        [[nodiscard]] std::unique_ptr<Task> CreateTask_() const;
+        void Push_(std::unique_ptr<Task>&& task);
+        static void Drain_(const std::shared_ptr<State>& state);
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Strand class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename F, typename...Args>
+    auto Strand::AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        auto result = task_ptr->SetSyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        Push_(std::move(task_ptr));
+        return result;
+    }
+
+    template<typename F, typename...Args>
+    void Strand::AddAsyncTask(F&& job, Args&&... args) {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        Push_(std::move(task_ptr));
+    }
+
+}
+
+#endif // INCLUDE_GUARD_STRAND_HPP
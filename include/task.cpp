@@ -10,49 +10,136 @@ namespace vsock {
     // Task class defenition
     ////////////////////////////////////////////////////////////////////////////////
 
+    Task::Task() :
+        Task(std::pmr::get_default_resource())
+    {}
+
+    Task::Task(std::pmr::memory_resource* resource) :
+        vars{ resource },
+        resource_{ resource },
+        tag_{ },
+        trace_{ },
+        job_{ },
+        condition_{ }
+    {}
+
     Task::Task(Task&& other) :
         vars(std::move(other.vars)),
+        resource_{ other.resource_ },
         type_{ std::exchange(other.type_,TaskType::ASYNC) },
         is_void_{ std::exchange(other.is_void_,true) },
-        sync_task_{ std::exchange(other.sync_task_,{}) },
-        async_task_{ std::exchange(other.async_task_,{}) },
-        condition_{ std::exchange(other.condition_,{}) }
+        tag_{ std::exchange(other.tag_, TaskTag{}) },
+        deadline_{ std::exchange(other.deadline_, time_point_t::max()) },
+        expired_{ std::exchange(other.expired_, false) },
+        started_{ std::exchange(other.started_, false) },
+        affinity_{ std::exchange(other.affinity_, NO_AFFINITY) },
+        trace_{ std::exchange(other.trace_, TaskTrace::Record{}) },
+        job_{ std::move(other.job_) },
+        condition_{ std::move(other.condition_) }
     {}
 
     Task& Task::operator=(Task&& other) {
         if (this != &other) {
             vars = std::move(other.vars);
+            resource_ = other.resource_;
             type_ = std::exchange(other.type_, TaskType::ASYNC);
             is_void_ = std::exchange(other.is_void_, true);
-            sync_task_ = std::exchange(other.sync_task_, {});
-            async_task_ = std::exchange(other.async_task_, {});
-            condition_ = std::exchange(other.condition_, {});
+            tag_ = std::exchange(other.tag_, TaskTag{});
+            deadline_ = std::exchange(other.deadline_, time_point_t::max());
+            expired_ = std::exchange(other.expired_, false);
+            started_ = std::exchange(other.started_, false);
+            affinity_ = std::exchange(other.affinity_, NO_AFFINITY);
+            trace_ = std::exchange(other.trace_, TaskTrace::Record{});
+            job_ = std::move(other.job_);
+            condition_ = std::move(other.condition_);
         }
         return *this;
     }
 
+    void* Task::operator new(std::size_t size) {
+        return operator new(size, std::pmr::get_default_resource());
+    }
+
+    void* Task::operator new(std::size_t size, std::pmr::memory_resource* resource) {
+        std::byte* memory = static_cast<std::byte*>(resource->allocate(HEADER_SIZE + size, alignof(std::max_align_t)));
+        *reinterpret_cast<std::pmr::memory_resource**>(memory) = resource;
+        return memory + HEADER_SIZE;
+    }
+
+    void Task::operator delete(void* ptr, std::size_t size) noexcept {
+        if (!ptr) {
+            return;
+        }
+        std::byte* memory = static_cast<std::byte*>(ptr) - HEADER_SIZE;
+        std::pmr::memory_resource* resource = *reinterpret_cast<std::pmr::memory_resource**>(memory);
+        resource->deallocate(memory, HEADER_SIZE + size, alignof(std::max_align_t));
+    }
+
+    void Task::operator delete(void* ptr, std::pmr::memory_resource*) noexcept {
+        operator delete(ptr, sizeof(Task));
+    }
+
     bool Task::IsVoidResult() {
         return is_void_;
     }
 
+    std::pmr::memory_resource* Task::Resource() const noexcept {
+        return resource_;
+    }
+
+    void Task::SetTag(const TaskTag tag) noexcept {
+        tag_ = tag;
+    }
+
+    TaskTag Task::Tag() const noexcept {
+        return tag_;
+    }
+
+    void Task::SetDeadline(const time_point_t deadline) noexcept {
+        deadline_ = deadline;
+    }
+
+    Task::time_point_t Task::Deadline() const noexcept {
+        return deadline_;
+    }
+
+    bool Task::HasDeadline() const noexcept {
+        return deadline_ != time_point_t::max();
+    }
+
+    bool Task::Expire(const time_point_t now) {
+        if (started_ || now <= deadline_) {
+            return false;
+        }
+        expired_ = true;
+        if (type_ == TaskType::SYNC) {
+            job_(*this);
+        }
+        return true;
+    }
+
     bool Task::operator()() {
+        started_ = true;
         switch (type_) {
             case TaskType::SYNC: {
-                (*sync_task_)();
+                trace_.iterations = 1;
+                job_(*this);
                 return false;
             } break;
             case TaskType::LOOP: {
-                if (!condition_.get() || !async_task_.get()) {
+                if (!condition_ || !job_) {
                     throw std::runtime_error("condition or loop is not set");
                 }
-                if ((*condition_)(*this)) {
-                    (*async_task_)(*this);
+                if (condition_(*this)) {
+                    ++trace_.iterations;
+                    job_(*this);
                     return true;
                 }
                 return false;
             } break;
             default: { // TaskType::ASYNC
-                (*async_task_)(*this);
+                trace_.iterations = 1;
+                job_(*this);
                 return false;
             }
         }
@@ -1,11 +1,18 @@
 #ifndef INCLUDE_GUARD_TASK_HPP
 #define INCLUDE_GUARD_TASK_HPP
 
+#include <memory>
+#include <chrono>
 #include <cstdint>
 #include <cstddef>
 #include <functional>
 #include <future>
+#include <system_error>
+#include <memory_resource>
 
+#include <job.hpp>
+#include <task_tag.hpp>
+#include <task_trace.hpp>
 #include <varlist.hpp>
 
 namespace vsock {
@@ -19,11 +26,19 @@ namespace vsock {
         enum class TaskType : std::uint8_t { ASYNC, SYNC, LOOP };
     public:
 
-        Task() = default;
+        Task();
+        explicit Task(std::pmr::memory_resource* resource);
 
         Task(Task&& other);
         Task& operator=(Task&& other);
 
+        // Tasks remember the resource they were allocated from, so a plain
+        // delete (e.g. from std::unique_ptr<Task>) returns the memory there.
+        static void* operator new(std::size_t size);
+        static void* operator new(std::size_t size, std::pmr::memory_resource* resource);
+        static void operator delete(void* ptr, std::size_t size) noexcept;
+        static void operator delete(void* ptr, std::pmr::memory_resource* resource) noexcept;
+
         template<typename F, typename... Args>
         auto SetSyncJob(F&& job, Args&&... args);
 
@@ -37,6 +52,20 @@ namespace vsock {
         void SetCondition(F&& condition, Args&&... args);
 
         bool IsVoidResult();
+        std::pmr::memory_resource* Resource() const noexcept;
+
+        void SetTag(const TaskTag tag) noexcept;
+        TaskTag Tag() const noexcept;
+
+        using time_point_t = std::chrono::steady_clock::time_point;
+
+        void SetDeadline(const time_point_t deadline) noexcept;
+        time_point_t Deadline() const noexcept;
+        bool HasDeadline() const noexcept;
+        // Drops the task if its deadline is before now: a sync task's future
+        // gets a std::errc::timed_out system_error. Returns true if dropped.
+        // Once started, a task is never dropped, so a loop task keeps going.
+        bool Expire(const time_point_t now);
 
         bool operator()();
 
@@ -46,11 +75,24 @@ namespace vsock {
 
     private:
 
+        friend class ThreadPool;
+
+        std::pmr::memory_resource* resource_;
         TaskType type_{ TaskType::ASYNC };
         bool is_void_{ true };
-        std::unique_ptr<std::packaged_task<void(void)>> sync_task_;
-        std::unique_ptr<std::function<void(Task&)>> async_task_{ nullptr };
-        std::unique_ptr<std::function<bool(Task&)>> condition_{ nullptr };
+        TaskTag tag_;
+        time_point_t deadline_{ time_point_t::max() };
+        bool expired_{ false };
+        bool started_{ false };
+        // Affinity bucket a keyed task holds while queued or running.
+        std::uint32_t affinity_{ NO_AFFINITY };
+        // Filled in while the owning pool is recording; id 0 means untraced.
+        TaskTrace::Record trace_{ };
+        Job<void(Task&)> job_;
+        Job<bool(Task&)> condition_;
+
+        static constexpr std::size_t HEADER_SIZE{ alignof(std::max_align_t) };
+        static constexpr std::uint32_t NO_AFFINITY{ ~std::uint32_t{ 0 } };
 
     };
 
@@ -62,75 +104,65 @@ namespace vsock {
     inline auto Task::SetSyncJob(F&& job, Args && ...args) {
 
         type_ = TaskType::SYNC;
-        condition_.reset();
-        async_task_.reset();
+        condition_.Reset();
 
         using return_type = std::invoke_result_t<F, Args...>;
         using promise_type = std::promise<return_type>;
-        using bind_type = std::function<return_type(void)>;
 
         is_void_ = std::is_void_v<return_type>;
 
-        const std::shared_ptr<bind_type> bind_fnc_ptr = std::make_shared<bind_type>(std::bind(std::forward<F>(job), std::forward<Args>(args)...));
-        const std::shared_ptr<promise_type> task_promise_ptr = std::make_shared<promise_type>();
-        sync_task_.reset();
-        sync_task_ = std::make_unique<std::packaged_task<void(void)>>(
-            std::packaged_task([bind_fnc_ptr, task_promise_ptr]() {
+        promise_type task_promise(std::allocator_arg, std::pmr::polymorphic_allocator<std::byte>(resource_));
+        auto result = task_promise.get_future();
+        job_ = Job<void(Task&)>(
+            [bind_fnc = std::bind(std::forward<F>(job), std::forward<Args>(args)...), task_promise = std::move(task_promise)](Task& task) mutable {
             try {
+                if (task.expired_) {
+                    throw std::system_error(std::make_error_code(std::errc::timed_out), "task deadline exceeded");
+                }
                 if constexpr (std::is_void_v<return_type>) {
-                    (*bind_fnc_ptr)();
-                    task_promise_ptr->set_value();
+                    bind_fnc();
+                    task_promise.set_value();
                 }
                 else {
-                    task_promise_ptr->set_value((*bind_fnc_ptr)());
+                    task_promise.set_value(bind_fnc());
                 }
             }
             catch (...) {
                 try {
-                    task_promise_ptr->set_exception(std::current_exception());
+                    task_promise.set_exception(std::current_exception());
                 }
                 catch (...) {
                     throw std::runtime_error("set_exception() failed");
                 }
             }
-        }));
-
+        }, resource_);
 
-        return task_promise_ptr->get_future();
+        return result;
     }
 
     template<typename F, typename ...Args>
     inline void Task::SetAsyncJob(F&& job, Args && ...args) {
         type_ = TaskType::ASYNC;
-        sync_task_.reset();
-        condition_.reset();
+        condition_.Reset();
         is_void_ = true;
-        async_task_.reset();
-        async_task_ = std::make_unique<std::function<void(Task&)>>(
-            std::bind(std::forward<F>(job), std::forward<Args>(args)...)
-        );
+        job_ = Job<void(Task&)>(std::bind(std::forward<F>(job), std::forward<Args>(args)...), resource_);
     }
 
     template<typename F, typename ...Args>
     inline void Task::SetCondition(F&& condition, Args && ...args) {
+        if (type_ == TaskType::SYNC) {
+            job_.Reset();
+        }
         type_ = TaskType::LOOP;
         is_void_ = true;
-        sync_task_.reset();
-        condition_.reset();
-        condition_ = std::make_unique<std::function<bool(Task&)>>(
-            std::bind(std::forward<F>(condition), std::forward<Args>(args)...)
-        );
+        condition_ = Job<bool(Task&)>(std::bind(std::forward<F>(condition), std::forward<Args>(args)...), resource_);
     }
 
     template<typename F, typename ...Args>
     inline void Task::SetLoopJob(F&& loop, Args && ...args) {
         type_ = TaskType::LOOP;
         is_void_ = true;
-        sync_task_.reset();
-        async_task_.reset();
-        async_task_ = std::make_unique<std::function<void(Task&)>>(
-            std::bind(std::forward<F>(loop), std::forward<Args>(args)...)
-        );
+        job_ = Job<void(Task&)>(std::bind(std::forward<F>(loop), std::forward<Args>(args)...), resource_);
     }
 
 }
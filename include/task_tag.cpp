@@ -0,0 +1,172 @@
+#include <task_tag.hpp>
+
+#include <ctime>
+#include <mutex>
+#include <deque>
+#include <algorithm>
+#include <unordered_map>
+
+namespace vsock {
+
+    namespace {
+
+        struct TagRegistry {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::uint64_t> ids;
+            std::deque<std::string> names;
+        };
+
+        TagRegistry& Registry() {
+            static TagRegistry registry;
+            return registry;
+        }
+
+        // Single writer: a plain load/store pair is enough and avoids the
+        // locked read-modify-write on the per-task path.
+        template<typename T>
+        void Bump(std::atomic<T>& counter, const T delta) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // TaskTag class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    TaskTag::TaskTag() noexcept :
+        value_{ 0 }
+    {}
+
+    TaskTag::TaskTag(const std::uint32_t id) noexcept :
+        value_{ id }
+    {}
+
+    TaskTag::TaskTag(std::string_view name) :
+        value_{ 0 }
+    {
+        TagRegistry& registry = Registry();
+        const std::scoped_lock registry_lock(registry.mutex);
+        auto [entry, inserted] = registry.ids.try_emplace(std::string(name), NAMED_BIT | registry.names.size());
+        if (inserted) {
+            registry.names.push_back(entry->first);
+        }
+        value_ = entry->second;
+    }
+
+    std::uint64_t TaskTag::Value() const noexcept {
+        return value_;
+    }
+
+    std::string TaskTag::Name() const {
+        if (!(value_ & NAMED_BIT)) {
+            return value_ ? std::to_string(value_) : std::string("untagged");
+        }
+        TagRegistry& registry = Registry();
+        const std::scoped_lock registry_lock(registry.mutex);
+        return registry.names[value_ & ~NAMED_BIT];
+    }
+
+    TaskTag::operator bool() const noexcept {
+        return value_ != 0;
+    }
+
+    bool TaskTag::operator==(const TaskTag& rhs) const noexcept {
+        return value_ == rhs.value_;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // TagTable class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    TagTable::TagTable() noexcept :
+        slots_{ },
+        overflow_{ }
+    {}
+
+    TagTable::Stamp TagTable::Start(const TaskTag tag) noexcept {
+        Slot& slot = Find_(tag.Value());
+        const bool sampled = slot.count.load(std::memory_order_relaxed) % CPU_SAMPLE_PERIOD == 0;
+        return Stamp{ &slot, sampled ? ThreadCpu_() : -1, Wall_() };
+    }
+
+    void TagTable::Finish(const Stamp& stamp) noexcept {
+        const std::int64_t wall = Wall_() - stamp.wall;
+        if (stamp.cpu >= 0) {
+            Bump(stamp.slot->cpu, ThreadCpu_() - stamp.cpu);
+            Bump(stamp.slot->sampled_wall, wall);
+        }
+        Bump(stamp.slot->wall, wall);
+        Bump(stamp.slot->count, std::uint64_t{ 1 });
+    }
+
+    void TagTable::Merge(std::vector<TagUsage>& usage) const {
+        const auto merge = [&usage](const TaskTag tag, const Slot& slot) {
+            const std::uint64_t count = slot.count.load(std::memory_order_relaxed);
+            if (count == 0) {
+                return;
+            }
+            TagUsage* entry = nullptr;
+            for (TagUsage& candidate : usage) {
+                if (candidate.tag == tag) {
+                    entry = &candidate;
+                    break;
+                }
+            }
+            if (!entry) {
+                entry = &usage.emplace_back(TagUsage{ tag, std::chrono::nanoseconds{ 0 }, std::chrono::nanoseconds{ 0 }, 0 });
+            }
+            const std::int64_t wall = slot.wall.load(std::memory_order_relaxed);
+            const std::int64_t sampled_wall = slot.sampled_wall.load(std::memory_order_relaxed);
+            const double cpu = static_cast<double>(slot.cpu.load(std::memory_order_relaxed));
+            if (sampled_wall > 0) {
+                // One thread cannot use more CPU than wall time; the clamp
+                // hides sampling noise on very short tasks.
+                const std::int64_t estimate = static_cast<std::int64_t>(cpu * static_cast<double>(wall) / static_cast<double>(sampled_wall));
+                entry->cpu += std::chrono::nanoseconds{ std::min(estimate, wall) };
+            }
+            entry->wall += std::chrono::nanoseconds{ wall };
+            entry->count += count;
+        };
+        for (const Slot& slot : slots_) {
+            if (const std::uint64_t value = slot.tag.load(std::memory_order_acquire); value != 0) {
+                TaskTag tag;
+                tag.value_ = value;
+                merge(tag, slot);
+            }
+        }
+        merge(TaskTag{}, overflow_);
+    }
+
+    TagTable::Slot& TagTable::Find_(const std::uint64_t value) noexcept {
+        std::size_t index = static_cast<std::size_t>((value * 0x9E3779B97F4A7C15ull) >> 32) % CAPACITY;
+        for (std::size_t probe = 0; probe < CAPACITY; ++probe, index = (index + 1) % CAPACITY) {
+            const std::uint64_t current = slots_[index].tag.load(std::memory_order_relaxed);
+            if (current == value) {
+                return slots_[index];
+            }
+            if (current == 0) {
+                // Counters are zero until published, so a concurrent Merge()
+                // sees either nothing or a consistent empty entry.
+                slots_[index].tag.store(value, std::memory_order_release);
+                return slots_[index];
+            }
+        }
+        return overflow_;
+    }
+
+    std::int64_t TagTable::ThreadCpu_() noexcept {
+#if !defined(_WIN32)
+        timespec cpu;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == 0) {
+            return std::int64_t{ cpu.tv_sec } * 1'000'000'000 + cpu.tv_nsec;
+        }
+#endif
+        return 0;
+    }
+
+    std::int64_t TagTable::Wall_() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+}
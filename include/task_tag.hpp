@@ -0,0 +1,121 @@
+#ifndef INCLUDE_GUARD_TASK_TAG_HPP
+#define INCLUDE_GUARD_TASK_TAG_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <string_view>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // TaskTag class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Lightweight label used to account CPU and wall time per kind of task.
+    // Integer tags are free to build; a named tag is interned once in a global
+    // registry, so keep it around instead of rebuilding it per submission.
+    // The default tag means "untagged" and is not accounted.
+
+    class TaskTag {
+    public:
+
+        TaskTag() noexcept;
+        explicit TaskTag(const std::uint32_t id) noexcept;
+        explicit TaskTag(std::string_view name);
+
+        std::uint64_t Value() const noexcept;
+        std::string Name() const;
+
+        explicit operator bool() const noexcept;
+        bool operator==(const TaskTag& rhs) const noexcept;
+
+    private:
+
+        friend class TagTable;
+
+        static constexpr std::uint64_t NAMED_BIT{ std::uint64_t{ 1 } << 63 };
+
+        std::uint64_t value_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // TagUsage struct declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // cpu / wall close to 1 means the tag burns cycles, close to 0 that its
+    // tasks mostly wait.
+
+    struct TagUsage {
+        TaskTag tag;
+        std::chrono::nanoseconds cpu;
+        std::chrono::nanoseconds wall;
+        std::uint64_t count;
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // TagTable class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Per-worker accounting table: open addressing over a fixed number of
+    // slots, written only by its worker and read lock-free by Merge(). Tags
+    // beyond capacity are folded into the untagged slot. Wall time is taken
+    // for every task; thread CPU time costs a syscall, so it is read for one
+    // task in CPU_SAMPLE_PERIOD per tag (the first included) and scaled by
+    // the wall time of the sampled tasks.
+
+    class TagTable {
+    public:
+
+        TagTable(const TagTable&) = delete;
+        TagTable& operator=(const TagTable&) = delete;
+
+    public:
+
+        static constexpr std::size_t CAPACITY{ 64 };
+        static constexpr std::uint64_t CPU_SAMPLE_PERIOD{ 16 };
+
+    private:
+
+        struct Slot {
+            std::atomic<std::uint64_t> tag;
+            std::atomic<std::int64_t> cpu;
+            std::atomic<std::int64_t> sampled_wall;
+            std::atomic<std::int64_t> wall;
+            std::atomic<std::uint64_t> count;
+        };
+
+    public:
+
+        struct Stamp {
+            Slot* slot;
+            // Negative when CPU time is not sampled for this task.
+            std::int64_t cpu;
+            std::int64_t wall;
+        };
+
+        TagTable() noexcept;
+
+        Stamp Start(const TaskTag tag) noexcept;
+        void Finish(const Stamp& stamp) noexcept;
+        void Merge(std::vector<TagUsage>& usage) const;
+
+    private:
+
+        std::array<Slot, CAPACITY> slots_;
+        Slot overflow_;
+
+        Slot& Find_(const std::uint64_t value) noexcept;
+        static std::int64_t ThreadCpu_() noexcept;
+        static std::int64_t Wall_() noexcept;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_TASK_TAG_HPP
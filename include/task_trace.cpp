@@ -0,0 +1,71 @@
+#include <task_trace.hpp>
+
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // TaskTrace class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    TaskTrace::TaskTrace(std::vector<Record> records) :
+        records_{ std::move(records) }
+    {
+        std::stable_sort(records_.begin(), records_.end(), [](const Record& lhs, const Record& rhs) {
+            return lhs.submitted < rhs.submitted;
+        });
+    }
+
+    const std::vector<TaskTrace::Record>& TaskTrace::Records() const noexcept {
+        return records_;
+    }
+
+    std::size_t TaskTrace::Size() const noexcept {
+        return records_.size();
+    }
+
+    bool TaskTrace::Empty() const noexcept {
+        return records_.empty();
+    }
+
+    void TaskTrace::Save(std::ostream& stream) const {
+        Header header{ };
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.record_size = sizeof(Record);
+        header.count = records_.size();
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(records_.data()), static_cast<std::streamsize>(records_.size() * sizeof(Record)));
+        if (!stream) {
+            throw std::runtime_error("task trace write failed");
+        }
+    }
+
+    TaskTrace TaskTrace::Load(std::istream& stream) {
+        Header header{ };
+        if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("not a task trace");
+        }
+        if (header.version != VERSION || header.record_size != sizeof(Record)) {
+            throw std::runtime_error("unsupported task trace version");
+        }
+        // The count comes from the file, so records are read in chunks and
+        // memory only grows with data that is actually there.
+        std::vector<Record> records;
+        while (records.size() < header.count) {
+            const std::size_t offset = records.size();
+            const std::size_t chunk = static_cast<std::size_t>(std::min<std::uint64_t>(header.count - offset, LOAD_CHUNK));
+            records.resize(offset + chunk);
+            if (!stream.read(reinterpret_cast<char*>(records.data() + offset), static_cast<std::streamsize>(chunk * sizeof(Record)))) {
+                throw std::runtime_error("task trace is truncated");
+            }
+        }
+        TaskTrace trace;
+        trace.records_ = std::move(records);
+        return trace;
+    }
+
+}
@@ -0,0 +1,69 @@
+#ifndef INCLUDE_GUARD_TASK_TRACE_HPP
+#define INCLUDE_GUARD_TASK_TRACE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // TaskTrace class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Workload captured by ThreadPool::StartRecording(): one fixed-size record
+    // per finished task, ordered by submission. Times are nanoseconds since
+    // recording began. Save() writes a small header followed by the records
+    // as they are laid out in memory, so a trace is read back on a machine
+    // of the same endianness.
+
+    class TaskTrace {
+    public:
+
+        struct Record {
+            std::uint64_t id;
+            // Task that was running on the submitting worker; 0 if none.
+            std::uint64_t parent;
+            std::int64_t submitted;
+            // From submission to the first start.
+            std::int64_t delay;
+            // Running time, summed over LOOP iterations.
+            std::int64_t duration;
+            // Submitting thread, numbered from 1 in order of first submission.
+            std::uint32_t thread;
+            // Job runs: 1 for SYNC and ASYNC tasks, 0 or more for LOOP ones.
+            std::uint32_t iterations;
+        };
+
+        TaskTrace() = default;
+        explicit TaskTrace(std::vector<Record> records);
+
+        const std::vector<Record>& Records() const noexcept;
+        std::size_t Size() const noexcept;
+        bool Empty() const noexcept;
+
+        void Save(std::ostream& stream) const;
+        static TaskTrace Load(std::istream& stream);
+
+    private:
+
+        static constexpr char MAGIC[8]{ 'V', 'S', 'T', 'R', 'A', 'C', 'E', '\0' };
+        static constexpr std::uint32_t VERSION{ 1 };
+        static constexpr std::size_t LOAD_CHUNK{ 4096 };
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t record_size;
+            std::uint64_t count;
+        };
+
+        std::vector<Record> records_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_TASK_TRACE_HPP
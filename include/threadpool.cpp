@@ -1,21 +1,84 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <utility>
+#include <vector>
+#include <numeric>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
 #include <threadpool.hpp>
+#include <scheduler.hpp>
+#include <probes.hpp>
 
 namespace vsock {
 
-    ThreadPool::ThreadPool(const std::size_t concurency, const DestroyType destroy_type) :
-        destroy_type_{ destroy_type },
-        threads_{ std::make_unique<std::thread[]>(ChooseThreadsCount_(concurency)) },
-        tasks_{ },
-        threads_count_{ ChooseThreadsCount_(concurency) },
+    namespace {
+
+        // Submitting threads are numbered in order of their first traced task.
+        std::uint32_t TraceThread() noexcept {
+            static std::atomic<std::uint32_t> threads{ 0 };
+            thread_local const std::uint32_t number = threads.fetch_add(1, std::memory_order_relaxed) + 1;
+            return number;
+        }
+
+    }
+
+    ThreadPool::ThreadPool(const Config& config) :
+        destroy_type_{ config.destroy_type },
+        start_type_{ config.start_type },
+        order_type_{ config.order_type },
+        resource_{ config.resource ? config.resource : std::pmr::get_default_resource() },
+        stack_{ config.stack },
+        budget_{ config.budget },
+        budget_member_{ budget_ ? &budget_->Join_(config.budget_weight) : nullptr },
+        flights_{ config.keyed_cache_size, config.keyed_cache_ttl, resource_ },
+        threads_{ resource_ },
+        contexts_{ resource_ },
+        tasks_{ resource_, order_type_ == OrderType::EDF },
+        local_tasks_{ resource_ },
+        affinity_map_{ resource_ },
+        affinity_load_{ resource_ },
+        channel_tasks_{ resource_ },
+        channels_{ resource_ },
+        channel_cursor_{ 0 },
+        operations_head_{ nullptr },
+        operations_tail_{ nullptr },
+        threads_count_{ ChooseThreadsCount_(config.concurency) },
+        threads_started_{ 0 },
+        tasks_expired_{ 0 },
+        recording_{ false },
+        recording_since_{ 0 },
+        trace_ids_{ 0 },
+        trace_first_{ 0 },
+        spares_{ resource_ },
+        spares_running_{ 0 },
+        blocked_count_{ 0 },
+        stall_threshold_{ config.stall_threshold },
+        watchdog_{ },
         tasks_running_{ 0 },
         working_{ false },
         paused_{ false },
-        waiting_{ false }
+        waiting_{ false },
+        reactor_leader_{ false },
+        stealing_{ false },
+        reactor_polling_{ false },
+        idle_count_{ 0 },
+        lent_tasks_{ 0 },
+        parked_{ resource_ },
+        reactor_{ },
+        file_service_{ }
     {
+        channels_.push_back(Channel{ "default", DEFAULT_CHANNEL_WEIGHT, 0, false, &tasks_ });
+        CreateAffinity_();
         CreateThreads_();
     }
 
+    ThreadPool::ThreadPool(const std::size_t concurency, const DestroyType destroy_type) :
+        ThreadPool(Config{ concurency, destroy_type, nullptr })
+    {}
+
     ThreadPool::ThreadPool() :
         ThreadPool(std::thread::hardware_concurrency(), DestroyType::SMOOTH)
     {}
@@ -30,10 +93,56 @@ namespace vsock {
 
     ThreadPool::~ThreadPool() {
         Finish_();
+        file_service_.reset();
+        if (budget_) {
+            budget_->Leave_(*budget_member_);
+        }
+    }
+
+    std::size_t AffinityKey::Hash() const noexcept {
+        return hash_;
+    }
+
+    ChannelId::ChannelId(const std::size_t index) noexcept :
+        index_{ index }
+    {}
+
+    std::size_t ChannelId::Index() const noexcept {
+        return index_;
+    }
+
+    BlockingScope::BlockingScope() :
+        context_{ WorkerContext::Current() }
+    {
+        if (context_ && context_->Pool()) {
+            context_->Pool()->EnterBlocking_(*context_);
+        }
+    }
+
+    BlockingScope::~BlockingScope() {
+        if (context_ && context_->Pool()) {
+            context_->Pool()->LeaveBlocking_(*context_);
+        }
     }
 
+    ThreadPool::Spare::Spare(std::pmr::memory_resource* resource) :
+        thread{ },
+        context{ resource },
+        retired{ true }
+    {}
+
     void ThreadPool::ClearTasks() noexcept {
-        tasks_.Clear();
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        for (Channel& channel : channels_) {
+            channel.tasks->Clear();
+            channel.deficit = 0;
+        }
+        std::unique_ptr<Task> task;
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            while (local_tasks_[index].TryPopFront(task)) {
+                Unpin_(*task);
+            }
+        }
     }
 
     void ThreadPool::Reset() {
@@ -56,30 +165,237 @@ namespace vsock {
         tasks_lock.unlock();
         Finish_();
         threads_count_ = ChooseThreadsCount_(concurency);
-        threads_ = std::make_unique<std::thread[]>(threads_count_);
+        CreateAffinity_();
         CreateThreads_();
         tasks_lock.lock();
         paused_ = was_paused;
     }
 
     void ThreadPool::AddSyncTask(std::unique_ptr<Task> task) {
+        Stamp_(*task);
         tasks_.PushBack(std::move(task));
-        tasks_available_cv_.notify_one();
+        NotifyTask_();
     }
 
     void ThreadPool::AddAsyncTask(std::unique_ptr<Task> task) {
+        Stamp_(*task);
         tasks_.PushBack(std::move(task));
-        tasks_available_cv_.notify_one();
+        NotifyTask_();
+    }
+
+    void ThreadPool::AddAsyncTask(const AffinityKey key, std::unique_ptr<Task> task) {
+        Stamp_(*task);
+        std::uint64_t mixed = key.Hash() + 0x9e3779b97f4a7c15ULL;
+        mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+        mixed ^= mixed >> 31;
+        const std::size_t bucket = static_cast<std::size_t>(mixed % (threads_count_ * AFFINITY_BUCKETS_PER_THREAD));
+        // Pinning and reading the owner in one step keeps a rebalance from
+        // moving the bucket while this task is on its way to the old owner.
+        const std::size_t target = static_cast<std::size_t>(affinity_map_[bucket].fetch_add(1, std::memory_order_acq_rel) >> AFFINITY_OWNER_SHIFT);
+        affinity_load_[bucket].fetch_add(1, std::memory_order_relaxed);
+        task->affinity_ = static_cast<std::uint32_t>(bucket);
+        local_tasks_[target].PushBack(std::move(task));
+        if (start_type_ == StartType::LAZY && threads_started_.load(std::memory_order_relaxed) < threads_count_) {
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            if (working_ && !threads_[target].Joinable()) {
+                StartWorker_(target);
+            }
+        }
+        if (stealing_.load(std::memory_order_relaxed)) {
+            NotifyTask_();
+        }
+        else {
+            // Only the owner may run it, so only the owner is woken.
+            if (idle_count_.load(std::memory_order_relaxed) > 0) {
+                const std::scoped_lock tasks_lock(tasks_mutex_);
+                WakeWorker_(target);
+            }
+            if (reactor_polling_.load(std::memory_order_acquire)) {
+                reactor_->Wake();
+            }
+        }
+    }
+
+    ChannelId ThreadPool::AddChannel(std::string name, const std::uint32_t weight) {
+        if (weight == 0) {
+            throw std::runtime_error("channel weight must be positive");
+        }
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        for (const Channel& channel : channels_) {
+            if (channel.name == name) {
+                throw std::runtime_error("channel \"" + name + "\" already exists");
+            }
+        }
+        TaskQueue& tasks = channel_tasks_.emplace_back(resource_, order_type_ == OrderType::EDF);
+        channels_.push_back(Channel{ std::move(name), weight, 0, false, &tasks });
+        return ChannelId(channels_.size() - 1);
+    }
+
+    ChannelId ThreadPool::FindChannel(const std::string& name) const {
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        for (std::size_t index = 0; index < channels_.size(); ++index) {
+            if (channels_[index].name == name) {
+                return ChannelId(index);
+            }
+        }
+        throw std::runtime_error("channel \"" + name + "\" does not exist");
+    }
+
+    ChannelId ThreadPool::DefaultChannel() const noexcept {
+        return ChannelId(0);
+    }
+
+    void ThreadPool::PauseChannel(const ChannelId channel) noexcept {
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        channels_[channel.index_].paused = true;
+    }
+
+    void ThreadPool::ContinueChannel(const ChannelId channel) noexcept {
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        channels_[channel.index_].paused = false;
+        WakeAll_();
+    }
+
+    void ThreadPool::AddSyncTask(const ChannelId channel, std::unique_ptr<Task> task) {
+        PushChannelTask_(channel, std::move(task));
+    }
+
+    void ThreadPool::AddAsyncTask(const ChannelId channel, std::unique_ptr<Task> task) {
+        PushChannelTask_(channel, std::move(task));
+    }
+
+    void ThreadPool::SetWorkStealing(const bool enabled) noexcept {
+        stealing_.store(enabled, std::memory_order_relaxed);
+        if (enabled) {
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            WakeAll_();
+        }
+    }
+
+    void ThreadPool::RebalanceAffinity() {
+        const std::size_t buckets_count = threads_count_ * AFFINITY_BUCKETS_PER_THREAD;
+        std::vector<std::size_t> buckets(buckets_count);
+        std::vector<std::size_t> loads(buckets_count);
+        std::iota(buckets.begin(), buckets.end(), 0);
+        for (std::size_t bucket = 0; bucket < buckets_count; ++bucket) {
+            loads[bucket] = affinity_load_[bucket].exchange(0, std::memory_order_relaxed);
+        }
+        std::stable_sort(buckets.begin(), buckets.end(), [&loads](const std::size_t lhs, const std::size_t rhs) {
+            return loads[lhs] > loads[rhs];
+        });
+        std::vector<std::size_t> thread_loads(threads_count_, 0);
+        std::vector<std::size_t> thread_buckets(threads_count_, 0);
+        for (const std::size_t bucket : buckets) {
+            std::size_t target = 0;
+            for (std::size_t index = 1; index < threads_count_; ++index) {
+                if (thread_loads[index] < thread_loads[target] ||
+                    (thread_loads[index] == thread_loads[target] && thread_buckets[index] < thread_buckets[target])) {
+                    target = index;
+                }
+            }
+            // Only an idle bucket moves; a busy one stays with its owner.
+            std::uint64_t owner = affinity_map_[bucket].load(std::memory_order_relaxed) >> AFFINITY_OWNER_SHIFT << AFFINITY_OWNER_SHIFT;
+            if (!affinity_map_[bucket].compare_exchange_strong(owner, std::uint64_t{ target } << AFFINITY_OWNER_SHIFT, std::memory_order_acq_rel)) {
+                target = static_cast<std::size_t>(owner >> AFFINITY_OWNER_SHIFT);
+            }
+            thread_loads[target] += loads[bucket];
+            ++thread_buckets[target];
+        }
+    }
+
+    void ThreadPool::WatchDescriptor(const int fd, const std::uint32_t events, Reactor::handler_t handler) {
+        {
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            if (!reactor_) {
+                reactor_ = std::make_unique<Reactor>();
+            }
+            SpawnWorker_();
+        }
+        reactor_->Add(fd, events, std::move(handler));
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        WakeAll_();
+    }
+
+    void ThreadPool::ModifyDescriptor(const int fd, const std::uint32_t events) {
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        if (!reactor_) {
+            throw std::runtime_error("descriptor is not registered");
+        }
+        reactor_->Modify(fd, events);
+    }
+
+    void ThreadPool::UnwatchDescriptor(const int fd) {
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        if (reactor_) {
+            reactor_->Remove(fd);
+        }
+    }
+
+    std::future<std::size_t> ThreadPool::ReadAsync(const int fd, std::span<std::byte> buffer, const std::uint64_t offset) {
+        auto promise = std::make_shared<std::promise<std::size_t>>();
+        auto result = promise->get_future();
+        Files_().Submit(FileService::Operation::READ, fd, buffer.data(), buffer.size(), offset, [promise](std::error_code error, std::size_t size) {
+            if (error) {
+                promise->set_exception(std::make_exception_ptr(std::system_error(error, "ReadAsync() failed")));
+            }
+            else {
+                promise->set_value(size);
+            }
+        }, FileService::Delivery::INLINE);
+        return result;
+    }
+
+    std::future<std::size_t> ThreadPool::WriteAsync(const int fd, std::span<const std::byte> buffer, const std::uint64_t offset) {
+        auto promise = std::make_shared<std::promise<std::size_t>>();
+        auto result = promise->get_future();
+        Files_().Submit(FileService::Operation::WRITE, fd, const_cast<std::byte*>(buffer.data()), buffer.size(), offset, [promise](std::error_code error, std::size_t size) {
+            if (error) {
+                promise->set_exception(std::make_exception_ptr(std::system_error(error, "WriteAsync() failed")));
+            }
+            else {
+                promise->set_value(size);
+            }
+        }, FileService::Delivery::INLINE);
+        return result;
+    }
+
+    std::future<void> ThreadPool::FsyncAsync(const int fd) {
+        auto promise = std::make_shared<std::promise<void>>();
+        auto result = promise->get_future();
+        Files_().Submit(FileService::Operation::FSYNC, fd, nullptr, 0, 0, [promise](std::error_code error, std::size_t) {
+            if (error) {
+                promise->set_exception(std::make_exception_ptr(std::system_error(error, "FsyncAsync() failed")));
+            }
+            else {
+                promise->set_value();
+            }
+        }, FileService::Delivery::INLINE);
+        return result;
+    }
+
+    void ThreadPool::ReadAsync(const int fd, std::span<std::byte> buffer, const std::uint64_t offset, FileService::handler_t handler) {
+        Files_().Submit(FileService::Operation::READ, fd, buffer.data(), buffer.size(), offset, std::move(handler));
+    }
+
+    void ThreadPool::WriteAsync(const int fd, std::span<const std::byte> buffer, const std::uint64_t offset, FileService::handler_t handler) {
+        Files_().Submit(FileService::Operation::WRITE, fd, const_cast<std::byte*>(buffer.data()), buffer.size(), offset, std::move(handler));
+    }
+
+    void ThreadPool::FsyncAsync(const int fd, FileService::handler_t handler) {
+        Files_().Submit(FileService::Operation::FSYNC, fd, nullptr, 0, 0, std::move(handler));
     }
 
     void ThreadPool::Wait() noexcept {
         std::unique_lock tasks_lock(tasks_mutex_);
+        VSOCK_PROBE(wait_enter, nullptr, ProbeWorker(), tasks_running_);
         waiting_ = true;
         tasks_done_cv_.wait(
             tasks_lock,
-            [this] {return (tasks_running_ == 0) && (paused_ || tasks_.Empty());}
+            [this] {return (tasks_running_ == 0) && (paused_ || !HasPendingTasks_());}
         );
         waiting_ = false;
+        VSOCK_PROBE(wait_exit, nullptr, ProbeWorker(), tasks_running_);
     }
 
     void ThreadPool::Pause() noexcept {
@@ -88,11 +404,139 @@ namespace vsock {
     }
 
     void ThreadPool::Continue() noexcept {
-        {
-            const std::scoped_lock tasks_lock(tasks_mutex_);
-            paused_ = false;
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        paused_ = false;
+        WakeAll_();
+    }
+
+    WorkerContext* ThreadPool::CurrentWorker() noexcept {
+        return WorkerContext::current_;
+    }
+
+    std::size_t ThreadPool::ThreadsCount() const noexcept {
+        return threads_count_;
+    }
+
+    exec::PoolScheduler ThreadPool::GetScheduler() noexcept {
+        return exec::PoolScheduler(*this);
+    }
+
+    std::size_t ThreadPool::ThreadsStarted() const noexcept {
+        return threads_started_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t ThreadPool::TasksExpired() const noexcept {
+        return tasks_expired_.load(std::memory_order_relaxed);
+    }
+
+    std::vector<TagUsage> ThreadPool::TagReport() const {
+        std::vector<TagUsage> usage;
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        for (const WorkerContext& context : contexts_) {
+            context.tags_.Merge(usage);
+        }
+        for (const Spare& spare : spares_) {
+            spare.context.tags_.Merge(usage);
+        }
+        return usage;
+    }
+
+    void ThreadPool::StartRecording() {
+        const auto clear = [](WorkerContext& context) {
+            const std::scoped_lock trace_lock(context.trace_mutex_);
+            context.traced_.clear();
+        };
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        for (WorkerContext& context : contexts_) {
+            clear(context);
+        }
+        for (Spare& spare : spares_) {
+            clear(spare.context);
+        }
+        recording_since_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+        trace_first_ = trace_ids_.load(std::memory_order_relaxed) + 1;
+        recording_.store(true, std::memory_order_release);
+    }
+
+    TaskTrace ThreadPool::StopRecording() {
+        recording_.store(false, std::memory_order_release);
+        std::vector<TaskTrace::Record> records;
+        const auto collect = [this, &records](WorkerContext& context) {
+            const std::scoped_lock trace_lock(context.trace_mutex_);
+            // Older ids are leftovers of a previous recording.
+            std::copy_if(context.traced_.begin(), context.traced_.end(), std::back_inserter(records), [this](const TaskTrace::Record& record) {
+                return record.id >= trace_first_;
+            });
+            context.traced_.clear();
+        };
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        for (WorkerContext& context : contexts_) {
+            collect(context);
+        }
+        for (Spare& spare : spares_) {
+            collect(spare.context);
+        }
+        return TaskTrace(std::move(records));
+    }
+
+    bool ThreadPool::Recording() const noexcept {
+        return recording_.load(std::memory_order_relaxed);
+    }
+
+    ThreadPool::Footprint ThreadPool::MemoryFootprint() const {
+        Footprint footprint{ 0, 0, 0 };
+        const auto account = [&footprint](const WorkerThread& thread) {
+            if (thread.Joinable()) {
+                ++footprint.threads;
+                footprint.stack_reserved += thread.StackReserved();
+                footprint.stack_resident += thread.StackResident();
+            }
+        };
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        for (const WorkerThread& thread : threads_) {
+            account(thread);
+        }
+        for (const Spare& spare : spares_) {
+            account(spare.thread);
+        }
+        account(watchdog_);
+        return footprint;
+    }
+
+    std::pmr::memory_resource* ThreadPool::Resource() const noexcept {
+        return resource_;
+    }
+
+    std::unique_ptr<Task> ThreadPool::CreateTask_() {
+        std::unique_ptr<Task> task(new (resource_) Task(resource_));
+        Stamp_(*task);
+        return task;
+    }
+
+    std::int64_t ThreadPool::TraceClock_() const noexcept {
+        const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        return now - recording_since_.load(std::memory_order_relaxed);
+    }
+
+    void ThreadPool::Stamp_(Task& task) noexcept {
+        if (!recording_.load(std::memory_order_acquire) || task.trace_.id != 0) {
+            return;
+        }
+        const WorkerContext* const context = WorkerContext::Current();
+        task.trace_.id = trace_ids_.fetch_add(1, std::memory_order_relaxed) + 1;
+        task.trace_.parent = context && context->pool_ == this ? context->tracing_ : 0;
+        task.trace_.submitted = TraceClock_();
+        task.trace_.delay = -1;
+        task.trace_.thread = TraceThread();
+    }
+
+    void ThreadPool::Trace_(WorkerContext& context, Task& task, const std::int64_t started, const bool again) {
+        context.tracing_ = 0;
+        task.trace_.duration += TraceClock_() - started;
+        if (!again) {
+            const std::scoped_lock trace_lock(context.trace_mutex_);
+            context.traced_.push_back(task.trace_);
         }
-        tasks_available_cv_.notify_all();
     }
 
     std::size_t ThreadPool::ChooseThreadsCount_(const std::size_t threads_count) const noexcept {
@@ -105,28 +549,317 @@ namespace vsock {
         return 1;
     }
 
+    void ThreadPool::NotifyTask_() {
+        // A worker bumps idle_count_ before it last checks the queues, so a
+        // zero here means nobody can be parked on a task just pushed.
+        if (idle_count_.load(std::memory_order_relaxed) > 0) {
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            WakeOne_();
+        }
+        if (reactor_polling_.load(std::memory_order_acquire) && idle_count_.load(std::memory_order_relaxed) == 0) {
+            reactor_->Wake();
+        }
+        if (start_type_ == StartType::LAZY &&
+            threads_started_.load(std::memory_order_relaxed) < threads_count_ &&
+            idle_count_.load(std::memory_order_relaxed) == 0) {
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            SpawnWorker_();
+        }
+    }
+
+    void ThreadPool::Unpin_(Task& task) noexcept {
+        if (task.affinity_ != Task::NO_AFFINITY) {
+            affinity_map_[task.affinity_].fetch_sub(1, std::memory_order_release);
+            task.affinity_ = Task::NO_AFFINITY;
+        }
+    }
+
+    // Park and wake expect tasks_mutex_ to be held. A woken worker is taken
+    // off parked_ by its waker, so two wakeups never land on the same one.
+
+    void ThreadPool::Park_(WorkerContext& context, std::unique_lock<std::mutex>& tasks_lock) {
+        parked_.push_back(&context);
+        context.parked_ = true;
+        context.wake_.wait(tasks_lock);
+        if (context.parked_) {
+            // Spurious wakeup.
+            parked_.erase(std::find(parked_.begin(), parked_.end(), &context));
+            context.parked_ = false;
+        }
+    }
+
+    void ThreadPool::WakeOne_(const bool leader) noexcept {
+        for (auto position = parked_.rbegin(); position != parked_.rend(); ++position) {
+            WorkerContext* const context = *position;
+            if (leader && context->index_ >= threads_count_) {
+                continue;
+            }
+            parked_.erase(std::next(position).base());
+            context->parked_ = false;
+            context->wake_.notify_one();
+            return;
+        }
+    }
+
+    void ThreadPool::WakeAll_() noexcept {
+        for (WorkerContext* const context : parked_) {
+            context->parked_ = false;
+            context->wake_.notify_one();
+        }
+        parked_.clear();
+    }
+
+    void ThreadPool::WakeWorker_(const std::size_t index) noexcept {
+        WorkerContext& context = contexts_[index];
+        if (context.parked_) {
+            parked_.erase(std::find(parked_.begin(), parked_.end(), &context));
+            context.parked_ = false;
+            context.wake_.notify_one();
+        }
+    }
+
+    FileService& ThreadPool::Files_() {
+        std::call_once(file_service_flag_, [this] {
+            file_service_ = std::make_unique<FileService>(*this);
+        });
+        return *file_service_;
+    }
+
+    void ThreadPool::CreateAffinity_() {
+        const std::size_t buckets_count = threads_count_ * AFFINITY_BUCKETS_PER_THREAD;
+        local_tasks_.clear();
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            local_tasks_.emplace_back(resource_, order_type_ == OrderType::EDF);
+        }
+        std::pmr::vector<std::atomic<std::uint64_t>> affinity_map(buckets_count, resource_);
+        std::pmr::vector<std::atomic<std::size_t>> affinity_load(buckets_count, resource_);
+        affinity_map_.swap(affinity_map);
+        affinity_load_.swap(affinity_load);
+        for (std::size_t bucket = 0; bucket < buckets_count; ++bucket) {
+            affinity_map_[bucket].store(std::uint64_t{ bucket % threads_count_ } << AFFINITY_OWNER_SHIFT, std::memory_order_relaxed);
+            affinity_load_[bucket].store(0, std::memory_order_relaxed);
+        }
+    }
+
     void ThreadPool::CreateThreads_() {
 
+        threads_.clear();
+        contexts_.clear();
+        threads_.resize(threads_count_);
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            WorkerContext& context = contexts_.emplace_back(resource_);
+            context.index_ = index;
+            context.pool_ = this;
+        }
+
+        spares_.clear();
+
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        tasks_running_ = 0;
+        threads_started_.store(0, std::memory_order_relaxed);
+        spares_running_ = 0;
+        blocked_count_ = 0;
+        working_ = true;
+        if (stall_threshold_.count() > 0) {
+            watchdog_ = WorkerThread(stack_, [this] { Watch_(); });
+        }
+        if (start_type_ == StartType::EAGER) {
+            for (std::size_t index = 0; index < threads_count_; ++index) {
+                StartWorker_(index);
+            }
+        }
+        else if (reactor_ || HasPendingTasks_()) {
+            SpawnWorker_();
+        }
+
+    }
+
+    // Both expect tasks_mutex_ to be held. A starting worker counts as idle
+    // until it reaches the task loop, so a burst of submissions does not
+    // start more workers than it needs.
+
+    void ThreadPool::StartWorker_(const std::size_t index) {
+        ++tasks_running_;
+        idle_count_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            threads_[index] = WorkerThread(stack_, [this, index] { Process_(index); });
+        }
+        catch (...) {
+            --tasks_running_;
+            idle_count_.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+        threads_started_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ThreadPool::SpawnWorker_() {
+        if (start_type_ == StartType::EAGER || !working_ ||
+            idle_count_.load(std::memory_order_relaxed) > 0 ||
+            threads_started_.load(std::memory_order_relaxed) == threads_count_) {
+            return;
+        }
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            if (!threads_[index].Joinable()) {
+                StartWorker_(index);
+                return;
+            }
+        }
+    }
+
+    // Blocking bookkeeping runs under tasks_mutex_. Every blocked worker is
+    // matched by one spare; spares left over once the blocking ends linger for
+    // SPARE_KEEPALIVE so back-to-back blocking calls reuse them, then retire.
+
+    void ThreadPool::StartSpare_() {
+        std::size_t slot = 0;
+        while (slot < spares_.size() && !spares_[slot].retired) {
+            ++slot;
+        }
+        if (slot == spares_.size()) {
+            spares_.emplace_back(resource_);
+        }
+        Spare& spare = spares_[slot];
+        if (spare.thread.Joinable()) {
+            spare.thread.Join();
+        }
+        spare.context.index_ = threads_count_ + slot;
+        spare.context.pool_ = this;
+        ++tasks_running_;
+        ++spares_running_;
+        idle_count_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            spare.thread = WorkerThread(stack_, [this, slot] { Process_(threads_count_ + slot); });
+        }
+        catch (...) {
+            --tasks_running_;
+            --spares_running_;
+            idle_count_.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+        spare.retired = false;
+    }
+
+    void ThreadPool::Compensate_() noexcept {
+        if (spares_running_ >= blocked_count_) {
+            spares_cv_.notify_all();
+            return;
+        }
+        if (!working_ || spares_running_ >= MAX_SPARE_WORKERS) {
+            return;
+        }
+        try {
+            StartSpare_();
+        }
+        catch (const std::system_error&) {
+            // Out of threads: the pool carries on without compensation.
+        }
+    }
+
+    void ThreadPool::EnterBlocking_(WorkerContext& context) noexcept {
+        const std::scoped_lock tasks_lock(tasks_mutex_);
+        if (context.blocking_++ == 0) {
+            // A blocked worker is not running, so its budget slot is lent out.
+            context.budget_lent_ = context.budgeted_;
+            DropSlot_(context);
+            ++blocked_count_;
+            Compensate_();
+        }
+    }
+
+    void ThreadPool::LeaveBlocking_(WorkerContext& context) noexcept {
+        bool reclaim{ false };
         {
             const std::scoped_lock tasks_lock(tasks_mutex_);
-            tasks_running_ = threads_count_;
-            working_ = true;
+            if (--context.blocking_ == 0) {
+                ReleaseBlocked_();
+                reclaim = std::exchange(context.budget_lent_, false);
+            }
+        }
+        if (reclaim) {
+            TakeSlot_(context);
         }
+    }
 
-        for (std::size_t index = 0; index < threads_count_; ++index) {
-            threads_[index] = std::thread(&ThreadPool::Process_, this);
+    // Budget slots are only taken without tasks_mutex_ held; dropping one
+    // under it is fine since the budget never calls back into the pool.
+
+    void ThreadPool::TakeSlot_(WorkerContext& context) noexcept {
+        context.budgeted_ = budget_->Acquire_(*budget_member_);
+    }
+
+    void ThreadPool::DropSlot_(WorkerContext& context) noexcept {
+        if (context.budgeted_) {
+            budget_->Release_(*budget_member_);
+            context.budgeted_ = false;
         }
+    }
+
+    void ThreadPool::ReleaseBlocked_() noexcept {
+        --blocked_count_;
+        if (spares_running_ > blocked_count_) {
+            WakeAll_();
+        }
+    }
+
+    bool ThreadPool::Surplus_(const std::size_t index) const noexcept {
+        return index >= threads_count_ && spares_running_ > blocked_count_;
+    }
 
+    void ThreadPool::Watch_() {
+        std::unique_lock tasks_lock(tasks_mutex_);
+        while (!watchdog_cv_.wait_for(tasks_lock, stall_threshold_ / 2, [this] { return !working_; })) {
+            const std::int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+            const std::int64_t threshold = std::chrono::duration_cast<std::chrono::steady_clock::duration>(stall_threshold_).count();
+            for (std::size_t index = 0; index < threads_count_; ++index) {
+                WorkerContext& context = contexts_[index];
+                const std::int64_t since = context.busy_since_.load();
+                if (since == 0 || now - since < threshold || context.blocking_ > 0 || context.stalled_.load()) {
+                    continue;
+                }
+                // Flag first, then confirm the same task is still running; the
+                // worker clears its timestamp before it checks the flag, so one
+                // side always sees the other.
+                context.stalled_.store(true);
+                ++blocked_count_;
+                if (context.busy_since_.load() == since) {
+                    Compensate_();
+                }
+                else if (context.stalled_.exchange(false)) {
+                    --blocked_count_;
+                }
+            }
+        }
     }
 
     void ThreadPool::StopThreads_() {
         {
             const std::scoped_lock tasks_lock(tasks_mutex_);
             working_ = false;
+            if (reactor_) {
+                reactor_->Wake();
+            }
+            WakeAll_();
+        }
+        if (budget_) {
+            budget_->Interrupt_(*budget_member_, true);
         }
-        tasks_available_cv_.notify_all();
-        for (std::size_t i = 0; i < threads_count_; ++i) {
-            threads_[i].join();
+        spares_cv_.notify_all();
+        watchdog_cv_.notify_all();
+        if (watchdog_.Joinable()) {
+            watchdog_.Join();
+        }
+        for (WorkerThread& thread : threads_) {
+            if (thread.Joinable()) {
+                thread.Join();
+            }
+        }
+        for (Spare& spare : spares_) {
+            if (spare.thread.Joinable()) {
+                spare.thread.Join();
+            }
+        }
+        if (budget_) {
+            budget_->Interrupt_(*budget_member_, false);
         }
     }
 
@@ -145,34 +878,433 @@ namespace vsock {
         }
     }
 
-    void ThreadPool::Process_() {
+    void ThreadPool::CreateWorkerState_(WorkerContext& context) {
+        std::shared_ptr<const state_factory_t> state_factory;
+        {
+            const std::scoped_lock factory_lock(state_factory_mutex_);
+            state_factory = state_factory_;
+        }
+        if (state_factory) {
+            (*state_factory)(context.state_, context.index_);
+        }
+    }
+
+    bool ThreadPool::HasPendingTasks_() const noexcept {
+        if (operations_head_ || HasChannelTasks_()) {
+            return true;
+        }
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            if (!local_tasks_[index].Empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ThreadPool::HasTasksFor_(const std::size_t index) const noexcept {
+        if (operations_head_ || HasChannelTasks_() || (index < threads_count_ && !local_tasks_[index].Empty()) || HasFrames_() ||
+            lent_tasks_.load(std::memory_order_relaxed) > 0) {
+            return true;
+        }
+        return stealing_.load(std::memory_order_relaxed) && HasPendingTasks_();
+    }
+
+    bool ThreadPool::HasChannelTasks_() const noexcept {
+        for (const Channel& channel : channels_) {
+            if (!channel.paused && !channel.tasks->Empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    TaskQueue* ThreadPool::PopChannelTask_(TaskQueue::deque_t& batch, const std::size_t limit, std::size_t& channel) {
+        if (channels_.size() == 1) {
+            channel = 0;
+            return channels_[0].paused || !tasks_.TryPopFront(batch, limit, threads_count_) ? nullptr : &tasks_;
+        }
+
+        // Deficit round-robin: the channel under the cursor is served while it
+        // has credit, credit is charged by measured runtime, and a new round
+        // tops up every backlogged channel by weight * quantum.
+        for (int round = 0; round < 2; ++round) {
+            for (std::size_t offset = 0; offset < channels_.size(); ++offset) {
+                const std::size_t index = (channel_cursor_ + offset) % channels_.size();
+                Channel& candidate = channels_[index];
+                if (candidate.paused) {
+                    continue;
+                }
+                if (candidate.tasks->Empty()) {
+                    candidate.deficit = std::min<std::int64_t>(candidate.deficit, 0);
+                    continue;
+                }
+                if (candidate.deficit > 0 && candidate.tasks->TryPopFront(batch, limit, threads_count_)) {
+                    channel_cursor_ = index;
+                    channel = index;
+                    return candidate.tasks;
+                }
+            }
+
+            std::int64_t rounds{ 0 };
+            for (const Channel& candidate : channels_) {
+                if (!candidate.paused && !candidate.tasks->Empty()) {
+                    const std::int64_t quantum = candidate.weight * CHANNEL_QUANTUM_NS;
+                    const std::int64_t needed = std::max<std::int64_t>((quantum - candidate.deficit) / quantum, 1);
+                    rounds = rounds == 0 ? needed : std::min(rounds, needed);
+                }
+            }
+            if (rounds == 0) {
+                return nullptr;
+            }
+            for (Channel& candidate : channels_) {
+                if (!candidate.paused && !candidate.tasks->Empty()) {
+                    candidate.deficit += rounds * candidate.weight * CHANNEL_QUANTUM_NS;
+                }
+            }
+            channel_cursor_ = (channel_cursor_ + 1) % channels_.size();
+        }
+        return nullptr;
+    }
+
+    void ThreadPool::PushChannelTask_(const ChannelId channel, std::unique_ptr<Task>&& task) {
+        Stamp_(*task);
+        {
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            channels_[channel.index_].tasks->PushBack(std::move(task));
+        }
+        NotifyTask_();
+    }
+
+    void ThreadPool::AddOperation_(exec::OperationBase& operation) noexcept {
+        {
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            operation.next_ = nullptr;
+            if (operations_tail_) {
+                operations_tail_->next_ = &operation;
+            }
+            else {
+                operations_head_ = &operation;
+            }
+            operations_tail_ = &operation;
+        }
+        NotifyTask_();
+    }
+
+    exec::OperationBase* ThreadPool::PopOperation_() noexcept {
+        exec::OperationBase* const operation = operations_head_;
+        if (operation) {
+            operations_head_ = operation->next_;
+            if (!operations_head_) {
+                operations_tail_ = nullptr;
+            }
+        }
+        return operation;
+    }
+
+    bool ThreadPool::HasFrames_() const noexcept {
+        for (const WorkerContext& context : contexts_) {
+            if (!context.spawns_.Empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    SpawnFrame* ThreadPool::StealFrame_(const std::size_t index) noexcept {
+        // Only base workers are robbed: spares_ may grow concurrently, so
+        // frames spawned on a spare are simply run inline by it at Sync.
+        const bool spare = index >= threads_count_;
+        for (std::size_t offset = spare ? 0 : 1; offset < threads_count_; ++offset) {
+            if (SpawnFrame* const frame = contexts_[(index + offset) % threads_count_].spawns_.Steal()) {
+                return frame;
+            }
+        }
+        return nullptr;
+    }
+
+    void ThreadPool::NotifySpawn_() noexcept {
+        // A missed wakeup only costs parallelism: the spawner runs whatever
+        // nobody stole itself, so the lock is only taken with someone idle.
+        if (idle_count_.load(std::memory_order_relaxed) > 0) {
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            WakeOne_();
+        }
+    }
+
+    TaskQueue* ThreadPool::PopTask_(const std::size_t index, TaskQueue::deque_t& batch, const std::size_t limit, std::size_t& channel) {
+        const bool stealing = stealing_.load(std::memory_order_relaxed);
+        const bool spare = index >= threads_count_;
+        channel = channels_.size();
+        if (!spare && local_tasks_[index].TryPopFront(batch, limit, stealing ? threads_count_ : 1)) {
+            return &local_tasks_[index];
+        }
+        if (TaskQueue* const origin = PopChannelTask_(batch, limit, channel)) {
+            return origin;
+        }
+        channel = channels_.size();
+        if (stealing) {
+            for (std::size_t offset = spare ? 0 : 1; offset < threads_count_; ++offset) {
+                TaskQueue& victim = local_tasks_[(index + offset) % threads_count_];
+                if (victim.TryPopFront(batch, 1, 1)) {
+                    return &victim;
+                }
+            }
+        }
+        return StealBatch_(index, batch);
+    }
+
+    TaskQueue* ThreadPool::StealBatch_(const std::size_t index, TaskQueue::deque_t& batch) {
+        if (lent_tasks_.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        // Take the back half of the first lent batch found; the owner keeps
+        // working from the front.
+        const auto steal = [&](WorkerContext& victim) -> TaskQueue* {
+            if (!victim.lent_ || victim.index_ == index) {
+                return nullptr;
+            }
+            const std::scoped_lock batch_lock(victim.batch_mutex_);
+            const std::size_t count = (victim.batch_.size() + 1) / 2;
+            if (count == 0) {
+                return nullptr;
+            }
+            const auto first = victim.batch_.end() - static_cast<std::ptrdiff_t>(count);
+            std::move(first, victim.batch_.end(), std::back_inserter(batch));
+            victim.batch_.erase(first, victim.batch_.end());
+            lent_tasks_.fetch_sub(count, std::memory_order_relaxed);
+            return victim.batch_origin_;
+        };
+        for (WorkerContext& victim : contexts_) {
+            if (TaskQueue* const origin = steal(victim)) {
+                return origin;
+            }
+        }
+        for (Spare& spare : spares_) {
+            if (TaskQueue* const origin = steal(spare.context)) {
+                return origin;
+            }
+        }
+        return nullptr;
+    }
+
+    std::size_t ThreadPool::BatchLimit_(const std::int64_t task_cost) noexcept {
+        const std::int64_t limit = BATCH_TARGET_NS / std::max<std::int64_t>(task_cost, 1);
+        return static_cast<std::size_t>(std::clamp<std::int64_t>(limit, 1, MAX_BATCH_SIZE));
+    }
+
+    void ThreadPool::Process_(const std::size_t index) {
         std::unique_lock tasks_lock(tasks_mutex_);
+        WorkerContext& context = index < threads_count_ ? contexts_[index] : spares_[index - threads_count_].context;
+        tasks_lock.unlock();
+        WorkerContext::current_ = &context;
+        CreateWorkerState_(context);
+
+        std::vector<Reactor::Ready> ready;
+        TaskQueue::deque_t unfinished;
+        std::int64_t task_cost{ BATCH_TARGET_NS };
+        const bool watched = stall_threshold_.count() > 0;
+        tasks_lock.lock();
+        idle_count_.fetch_sub(1, std::memory_order_relaxed);
         while (true) {
             --tasks_running_;
+            const bool done = waiting_ && tasks_running_ == 0 && (paused_ || !HasPendingTasks_());
             tasks_lock.unlock();
-            if (waiting_ && tasks_running_ == 0 && (paused_ || tasks_.Empty())) {
+            if (done) {
                 tasks_done_cv_.notify_all();
             }
             tasks_lock.lock();
-            tasks_available_cv_.wait(tasks_lock,
-                [this] {
-                return !(paused_ || tasks_.Empty()) || !working_;
-            });
-            
+            if (context.budgeted_ && (Surplus_(index) || paused_ || !HasTasksFor_(index) || budget_->Contended_(*budget_member_))) {
+                DropSlot_(context);
+            }
+            if (Surplus_(index)) {
+                const bool reclaimed = spares_cv_.wait_for(tasks_lock, SPARE_KEEPALIVE,
+                    [this, index] {
+                    return !working_ || !Surplus_(index);
+                });
+                if (!reclaimed || !working_) {
+                    --spares_running_;
+                    spares_[index - threads_count_].retired = true;
+                    DropSlot_(context);
+                    WorkerContext::current_ = nullptr;
+                    break;
+                }
+            }
+            idle_count_.fetch_add(1, std::memory_order_relaxed);
+            VSOCK_PROBE(park, nullptr, index, idle_count_.load(std::memory_order_relaxed));
+            while (!(!(paused_ || !HasTasksFor_(index)) || !working_ || (index < threads_count_ && reactor_ && !reactor_leader_) || Surplus_(index))) {
+                Park_(context, tasks_lock);
+            }
+            idle_count_.fetch_sub(1, std::memory_order_relaxed);
+            VSOCK_PROBE(unpark, nullptr, index, idle_count_.load(std::memory_order_relaxed));
+
             if (!working_) {
+                DropSlot_(context);
+                WorkerContext::current_ = nullptr;
                 break;
             }
 
+            if (Surplus_(index)) {
+                ++tasks_running_;
+                continue;
+            }
+
+            if (paused_ || !HasTasksFor_(index)) {
+                reactor_leader_ = true;
+                reactor_polling_.store(true, std::memory_order_release);
+                tasks_lock.unlock();
+                reactor_->Poll(ready, -1);
+                tasks_lock.lock();
+                reactor_polling_.store(false, std::memory_order_relaxed);
+                reactor_leader_ = false;
+                WakeOne_(true);
+                ++tasks_running_;
+                if (!ready.empty()) {
+                    tasks_lock.unlock();
+                    // The leader keeps one event and queues the rest, so the
+                    // followers run their handlers in parallel with it.
+                    for (std::size_t event = 1; event < ready.size(); ++event) {
+                        AddAsyncTask([this, ready = std::move(ready[event])] {
+                            reactor_->Dispatch(ready);
+                        });
+                    }
+                    reactor_->Dispatch(ready.front());
+                    ready.clear();
+                    context.scratch_.Reset();
+                    tasks_lock.lock();
+                }
+                continue;
+            }
+
             ++tasks_running_;
-            
 
-            std::unique_ptr<Task> task;
-            tasks_.PopFront(task);
+            if (budget_ && !context.budgeted_) {
+                tasks_lock.unlock();
+                TakeSlot_(context);
+                tasks_lock.lock();
+                if (!context.budgeted_) {
+                    // Interrupted: the pool is stopping.
+                    continue;
+                }
+            }
+
+            if (SpawnFrame* const frame = StealFrame_(index)) {
+                tasks_lock.unlock();
+                frame->Execute();
+                context.scratch_.Reset();
+                tasks_lock.lock();
+                continue;
+            }
+
+            if (exec::OperationBase* const operation = PopOperation_()) {
+                tasks_lock.unlock();
+                operation->execute_(operation);
+                context.scratch_.Reset();
+                tasks_lock.lock();
+                continue;
+            }
+
+            std::size_t channel{ 0 };
+            TaskQueue* const origin = PopTask_(index, context.batch_, BatchLimit_(task_cost), channel);
+            if (!origin) {
+                continue;
+            }
+            if (start_type_ == StartType::LAZY &&
+                idle_count_.load(std::memory_order_relaxed) == 0 &&
+                threads_started_.load(std::memory_order_relaxed) < threads_count_ &&
+                HasPendingTasks_()) {
+                // Keep growing while a backlog remains; on failure this
+                // worker simply carries on with the workers already running.
+                try {
+                    SpawnWorker_();
+                }
+                catch (const std::system_error&) {
+                }
+            }
+            const bool charged = channels_.size() > 1 && channel < channels_.size();
+            const bool shared = index >= threads_count_ || origin != &local_tasks_[index] || stealing_.load(std::memory_order_relaxed);
+            // Lend the batch out while it runs, so idle workers and spares
+            // can still reach tasks queued behind one that blocks.
+            context.batch_origin_ = origin;
+            context.lent_ = shared;
+            if (shared) {
+                lent_tasks_.fetch_add(context.batch_.size(), std::memory_order_relaxed);
+            }
             tasks_lock.unlock();
-            bool not_finished = (*task)();
+
+            const auto started = std::chrono::steady_clock::now();
+            std::int64_t executed{ 0 };
+            while (true) {
+                std::unique_ptr<Task> task;
+                std::size_t remaining{ 0 };
+                {
+                    const std::scoped_lock batch_lock(context.batch_mutex_);
+                    if (context.batch_.empty()) {
+                        break;
+                    }
+                    task = std::move(context.batch_.front());
+                    context.batch_.pop_front();
+                    remaining = context.batch_.size();
+                    if (shared) {
+                        lent_tasks_.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                }
+                if (task->HasDeadline() && task->Expire(std::chrono::steady_clock::now())) {
+                    tasks_expired_.fetch_add(1, std::memory_order_relaxed);
+                    Unpin_(*task);
+                    ++executed;
+                    continue;
+                }
+                if (watched) {
+                    context.busy_since_.store(std::chrono::steady_clock::now().time_since_epoch().count());
+                }
+                const TaskTag tag = task->Tag();
+                const TagTable::Stamp stamp = tag ? context.tags_.Start(tag) : TagTable::Stamp{ nullptr, -1, 0 };
+                const bool traced = task->trace_.id != 0;
+                const std::int64_t trace_started = traced ? TraceClock_() : 0;
+                if (traced) {
+                    if (task->trace_.delay < 0) {
+                        task->trace_.delay = trace_started - task->trace_.submitted;
+                    }
+                    context.tracing_ = task->trace_.id;
+                }
+                VSOCK_PROBE(task_start, task.get(), index, remaining);
+                const bool again = (*task)();
+                VSOCK_PROBE(task_end, task.get(), index, remaining);
+                if (tag) {
+                    context.tags_.Finish(stamp);
+                }
+                if (traced) {
+                    Trace_(context, *task, trace_started, again);
+                }
+                if (again) {
+                    unfinished.push_back(std::move(task));
+                }
+                else {
+                    Unpin_(*task);
+                }
+                if (watched) {
+                    context.busy_since_.store(0);
+                    if (context.stalled_.exchange(false)) {
+                        const std::scoped_lock stall_lock(tasks_mutex_);
+                        ReleaseBlocked_();
+                    }
+                }
+                context.scratch_.Reset();
+                ++executed;
+            }
+            const std::int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count();
+            if (executed > 0) {
+                task_cost = (task_cost * 3 + elapsed / executed) / 4;
+            }
+
             tasks_lock.lock();
-            if (not_finished) {
-                tasks_.PushBack(std::move(task));
+            if (charged) {
+                channels_[channel].deficit -= elapsed;
+            }
+            context.lent_ = false;
+            while (!unfinished.empty()) {
+                origin->Requeue(std::move(unfinished.front()));
+                unfinished.pop_front();
             }
 
         }
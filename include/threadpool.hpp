@@ -1,16 +1,99 @@
 #ifndef INCLUDE_GUARD_THREADPOOL_HPP
 #define INCLUDE_GUARD_THREADPOOL_HPP
 
+#include <chrono>
 #include <thread>
 #include <mutex>
 #include <deque>
+#include <span>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <condition_variable>
+#include <memory_resource>
 
 #include <task.hpp>
 #include <queue.hpp>
+#include <worker.hpp>
+#include <worker_thread.hpp>
+#include <budget.hpp>
+#include <single_flight.hpp>
+#include <fork_join.hpp>
+#include <task_trace.hpp>
+#include <completion_queue.hpp>
+#include <reactor.hpp>
+#include <file_service.hpp>
 
 namespace vsock {
 
+    namespace exec {
+        class OperationBase;
+        class PoolScheduler;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // AffinityKey class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class AffinityKey {
+    public:
+
+        template<typename K>
+        explicit AffinityKey(const K& key);
+
+        std::size_t Hash() const noexcept;
+
+    private:
+
+        std::size_t hash_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ChannelId class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class ChannelId {
+    public:
+
+        std::size_t Index() const noexcept;
+
+    private:
+
+        friend class ThreadPool;
+
+        explicit ChannelId(const std::size_t index) noexcept;
+
+        std::size_t index_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BlockingScope class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Marks the calling worker as blocked for the lifetime of the scope; the
+    // pool starts a compensating worker meanwhile. Does nothing off the pool.
+
+    class BlockingScope {
+    public:
+
+        BlockingScope(const BlockingScope&) = delete;
+        BlockingScope& operator=(const BlockingScope&) = delete;
+
+    public:
+
+        BlockingScope();
+        ~BlockingScope();
+
+    private:
+
+        WorkerContext* context_;
+
+    };
+
     //////////////////////////////////////////////////////////////////////////////////
     // ThreadPool class declaration
     ////////////////////////////////////////////////////////////////////////////////
@@ -28,6 +111,49 @@ namespace vsock {
             SHARP
         };
 
+        // LAZY starts a worker only when a submission finds none idle.
+        enum class StartType : std::uint8_t {
+            EAGER,
+            LAZY
+        };
+
+        // EDF queues tasks by deadline, earliest first, so that under
+        // saturation the pool serves requests that can still make it.
+        enum class OrderType : std::uint8_t {
+            FIFO,
+            EDF
+        };
+
+        // resource serves tasks, queues, payloads and worker bookkeeping;
+        // nullptr selects std::pmr::get_default_resource().
+        struct Config {
+            std::size_t concurency{ 0 };
+            DestroyType destroy_type{ DestroyType::SMOOTH };
+            std::pmr::memory_resource* resource{ nullptr };
+            StartType start_type{ StartType::EAGER };
+            // A task running longer than this is treated as blocked; 0 disables.
+            std::chrono::milliseconds stall_threshold{ 0 };
+            WorkerThread::Stack stack{ };
+            OrderType order_type{ OrderType::FIFO };
+            // Shared cap on running workers; budget_weight sets this pool's
+            // share of it under contention.
+            ConcurrencyBudget* budget{ nullptr };
+            std::uint32_t budget_weight{ 1 };
+            // Completed AddSyncTaskKeyed results kept for reuse; 0 disables
+            // the cache, a ttl of 0 keeps entries until evicted.
+            std::size_t keyed_cache_size{ 0 };
+            std::chrono::milliseconds keyed_cache_ttl{ 0 };
+        };
+
+        // Memory held by the pool's threads; resident counts the stack pages
+        // actually backed by RAM (Linux only, 0 elsewhere).
+        struct Footprint {
+            std::size_t threads;
+            std::size_t stack_reserved;
+            std::size_t stack_resident;
+        };
+
+        explicit ThreadPool(const Config& config);
         ThreadPool();
         ThreadPool(const DestroyType destroy_type);
         ThreadPool(const std::size_t concurency);
@@ -53,53 +179,379 @@ namespace vsock {
         template<typename F, typename...Args>
         void AddAsyncTask(F&& job, Args&&... args);
 
+        template<typename T, typename F, typename...Args>
+        void AddSyncTask(CompletionQueue<T>& queue, const std::size_t id, F&& job, Args&&... args);
+
+        void AddAsyncTask(const AffinityKey key, std::unique_ptr<Task> task);
+
+        template<typename F, typename...Args>
+        void AddAsyncTask(const AffinityKey key, F&& job, Args&&... args);
+
+        ChannelId AddChannel(std::string name, const std::uint32_t weight);
+        ChannelId FindChannel(const std::string& name) const;
+        ChannelId DefaultChannel() const noexcept;
+        void PauseChannel(const ChannelId channel) noexcept;
+        void ContinueChannel(const ChannelId channel) noexcept;
+
+        void AddSyncTask(const ChannelId channel, std::unique_ptr<Task> task);
+        void AddAsyncTask(const ChannelId channel, std::unique_ptr<Task> task);
+
+        template<typename F, typename...Args>
+        auto AddSyncTask(const ChannelId channel, F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
+
+        template<typename F, typename...Args>
+        void AddAsyncTask(const ChannelId channel, F&& job, Args&&... args);
+
+        template<typename F, typename...Args>
+        auto AddSyncTask(const TaskTag tag, F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
+
+        template<typename F, typename...Args>
+        void AddAsyncTask(const TaskTag tag, F&& job, Args&&... args);
+
+        // CPU time, wall time and count per tag, merged over all workers.
+        std::vector<TagUsage> TagReport() const;
+
+        // A task still queued at its deadline is dropped instead of run; a
+        // sync task's future then throws std::errc::timed_out.
+        using time_point_t = Task::time_point_t;
+
+        template<typename F, typename...Args>
+        auto AddSyncTask(const time_point_t deadline, F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
+
+        template<typename F, typename...Args>
+        void AddAsyncTask(const time_point_t deadline, F&& job, Args&&... args);
+
+        std::size_t TasksExpired() const noexcept;
+
+        // Recording mode: tasks submitted after StartRecording() are traced.
+        // StopRecording() returns those that have finished by then, so Wait()
+        // first to capture the whole workload; tools/trace_replay replays it.
+        void StartRecording();
+        TaskTrace StopRecording();
+        bool Recording() const noexcept;
+
+        // Submissions with a key equal to one queued, running or cached share
+        // its future instead of queuing the work again.
+        template<typename K, typename F, typename...Args>
+        auto AddSyncTaskKeyed(const K& key, F&& job, Args&&... args) -> std::shared_future<std::invoke_result_t<F, Args...>>;
+
+        void SetWorkStealing(const bool enabled) noexcept;
+        // Remaps hot buckets to even out load. A bucket with tasks still
+        // queued or running stays where it is until a later call, so tasks
+        // of one key never run on two workers at once.
+        void RebalanceAffinity();
+
+        void WatchDescriptor(const int fd, const std::uint32_t events, Reactor::handler_t handler);
+        void ModifyDescriptor(const int fd, const std::uint32_t events);
+        void UnwatchDescriptor(const int fd);
+
+        // The futures are fulfilled by the thread that reaps the completion,
+        // so a task may wait on them even when no other worker is free. The
+        // handler overloads post their handler to the pool as a task.
+        std::future<std::size_t> ReadAsync(const int fd, std::span<std::byte> buffer, const std::uint64_t offset);
+        std::future<std::size_t> WriteAsync(const int fd, std::span<const std::byte> buffer, const std::uint64_t offset);
+        std::future<void> FsyncAsync(const int fd);
+
+        void ReadAsync(const int fd, std::span<std::byte> buffer, const std::uint64_t offset, FileService::handler_t handler);
+        void WriteAsync(const int fd, std::span<const std::byte> buffer, const std::uint64_t offset, FileService::handler_t handler);
+        void FsyncAsync(const int fd, FileService::handler_t handler);
+
+        template<typename F>
+        void SetWorkerState(F&& factory);
+
+        static WorkerContext* CurrentWorker() noexcept;
+
+        template<typename F>
+        static auto Blocking(F&& fn) -> std::invoke_result_t<F>;
+
+        std::size_t ThreadsCount() const noexcept;
+        std::size_t ThreadsStarted() const noexcept;
+        Footprint MemoryFootprint() const;
+        exec::PoolScheduler GetScheduler() noexcept;
+        std::pmr::memory_resource* Resource() const noexcept;
+
     private:
 
+        friend class WorkerContext;
+        friend class BlockingScope;
+        friend class SpawnScope;
+        friend class exec::OperationBase;
+
+        using state_factory_t = std::function<void(VarNode&, std::size_t)>;
+
+        static constexpr std::size_t AFFINITY_BUCKETS_PER_THREAD{ 16 };
+        // An affinity_map_ entry packs the owning worker above this shift and
+        // the bucket's queued plus running tasks below it.
+        static constexpr std::uint32_t AFFINITY_OWNER_SHIFT{ 32 };
+        static constexpr std::uint32_t DEFAULT_CHANNEL_WEIGHT{ 1 };
+        static constexpr std::int64_t CHANNEL_QUANTUM_NS{ 100'000 };
+        static constexpr std::size_t MAX_BATCH_SIZE{ 32 };
+        static constexpr std::int64_t BATCH_TARGET_NS{ 20'000 };
+        static constexpr std::size_t MAX_SPARE_WORKERS{ 256 };
+        static constexpr std::chrono::milliseconds SPARE_KEEPALIVE{ 100 };
+
+        struct Channel {
+            std::string name;
+            std::uint32_t weight;
+            std::int64_t deficit;
+            bool paused;
+            TaskQueue* tasks;
+        };
+
+        // Compensating worker; its index is ThreadsCount() + slot.
+        struct Spare {
+            explicit Spare(std::pmr::memory_resource* resource);
+            WorkerThread thread;
+            WorkerContext context;
+            bool retired;
+        };
+
         DestroyType destroy_type_;
+        const StartType start_type_;
+        const OrderType order_type_;
+        std::pmr::memory_resource* resource_;
 
-        std::unique_ptr<std::thread[]> threads_;
+        const WorkerThread::Stack stack_;
+        ConcurrencyBudget* const budget_;
+        ConcurrencyBudget::Member* const budget_member_;
+        SingleFlight flights_;
+        std::pmr::vector<WorkerThread> threads_;
+        std::pmr::deque<WorkerContext> contexts_;
         TaskQueue tasks_;
+        std::pmr::deque<TaskQueue> local_tasks_;
+        std::pmr::vector<std::atomic<std::uint64_t>> affinity_map_;
+        std::pmr::vector<std::atomic<std::size_t>> affinity_load_;
+        std::pmr::deque<TaskQueue> channel_tasks_;
+        std::pmr::vector<Channel> channels_;
+        std::size_t channel_cursor_;
+        exec::OperationBase* operations_head_;
+        exec::OperationBase* operations_tail_;
 
         std::size_t threads_count_;
+        std::atomic<std::size_t> threads_started_;
+        std::atomic<std::size_t> tasks_expired_;
+        std::atomic_bool recording_;
+        std::atomic<std::int64_t> recording_since_;
+        std::atomic<std::uint64_t> trace_ids_;
+        std::uint64_t trace_first_;
+        std::pmr::deque<Spare> spares_;
+        std::size_t spares_running_;
+        std::size_t blocked_count_;
+        const std::chrono::milliseconds stall_threshold_;
+        WorkerThread watchdog_;
         std::size_t tasks_running_;
 
         bool working_;
         bool paused_;
         bool waiting_;
+        bool reactor_leader_;
+        std::atomic_bool stealing_;
+        std::atomic_bool reactor_polling_;
+        std::atomic<std::size_t> idle_count_;
+        std::atomic<std::size_t> lent_tasks_;
 
-        std::mutex tasks_mutex_;
+        mutable std::mutex tasks_mutex_;
 
-        std::condition_variable tasks_available_cv_;
+        std::pmr::vector<WorkerContext*> parked_;
         std::condition_variable tasks_done_cv_;
+        std::condition_variable spares_cv_;
+        std::condition_variable watchdog_cv_;
+
+        std::unique_ptr<Reactor> reactor_;
+        std::unique_ptr<FileService> file_service_;
+        std::once_flag file_service_flag_;
+
+        std::mutex state_factory_mutex_;
+        std::shared_ptr<const state_factory_t> state_factory_;
 
         [[nodiscard]] std::size_t ChooseThreadsCount_(const std::size_t threads_count) const noexcept;
+        [[nodiscard]] std::unique_ptr<Task> CreateTask_();
+        [[nodiscard]] std::int64_t TraceClock_() const noexcept;
+        void Stamp_(Task& task) noexcept;
+        void Trace_(WorkerContext& context, Task& task, const std::int64_t started, const bool again);
+        void NotifyTask_();
+        void Park_(WorkerContext& context, std::unique_lock<std::mutex>& tasks_lock);
+        void WakeOne_(const bool leader = false) noexcept;
+        void WakeAll_() noexcept;
+        void WakeWorker_(const std::size_t index) noexcept;
+        void Unpin_(Task& task) noexcept;
+        FileService& Files_();
+        void CreateAffinity_();
         void CreateThreads_();
+        void StartWorker_(const std::size_t index);
+        void SpawnWorker_();
+        void StartSpare_();
+        void Compensate_() noexcept;
+        void EnterBlocking_(WorkerContext& context) noexcept;
+        void LeaveBlocking_(WorkerContext& context) noexcept;
+        void ReleaseBlocked_() noexcept;
+        void TakeSlot_(WorkerContext& context) noexcept;
+        void DropSlot_(WorkerContext& context) noexcept;
+        [[nodiscard]] bool Surplus_(const std::size_t index) const noexcept;
+        void Watch_();
         void StopThreads_();
         void DestroyThreads_();
         void Finish_();
-        void Process_();
+        void CreateWorkerState_(WorkerContext& context);
+        [[nodiscard]] bool HasPendingTasks_() const noexcept;
+        [[nodiscard]] bool HasTasksFor_(const std::size_t index) const noexcept;
+        [[nodiscard]] bool HasChannelTasks_() const noexcept;
+        [[nodiscard]] TaskQueue* PopChannelTask_(TaskQueue::deque_t& batch, const std::size_t limit, std::size_t& channel);
+        [[nodiscard]] TaskQueue* PopTask_(const std::size_t index, TaskQueue::deque_t& batch, const std::size_t limit, std::size_t& channel);
+        [[nodiscard]] TaskQueue* StealBatch_(const std::size_t index, TaskQueue::deque_t& batch);
+        [[nodiscard]] static std::size_t BatchLimit_(const std::int64_t task_cost) noexcept;
+        void PushChannelTask_(const ChannelId channel, std::unique_ptr<Task>&& task);
+        void AddOperation_(exec::OperationBase& operation) noexcept;
+        [[nodiscard]] exec::OperationBase* PopOperation_() noexcept;
+        [[nodiscard]] bool HasFrames_() const noexcept;
+        [[nodiscard]] SpawnFrame* StealFrame_(const std::size_t index) noexcept;
+        void NotifySpawn_() noexcept;
+        void Process_(const std::size_t index);
 
     };
 
+    //////////////////////////////////////////////////////////////////////////////////
+    // AffinityKey class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename K>
+    inline AffinityKey::AffinityKey(const K& key) :
+        hash_{ std::hash<K>{}(key) }
+    {}
+
     //////////////////////////////////////////////////////////////////////////////////
     // ThreadPool class defenition (template methods)
     ////////////////////////////////////////////////////////////////////////////////
 
     template<typename F, typename...Args>
     auto ThreadPool::AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
-        std::unique_ptr<Task> task_ptr(std::make_unique<Task>());
+        std::unique_ptr<Task> task_ptr(CreateTask_());
         auto result = task_ptr->SetSyncJob(std::forward<F>(job), std::forward<Args>(args)...);
         tasks_.PushBack(std::move(task_ptr));
-        tasks_available_cv_.notify_one();
+        NotifyTask_();
         return result;
     }
 
     template<typename F, typename...Args>
     void ThreadPool::AddAsyncTask(F&& job, Args&&... args) {
-        std::unique_ptr<Task> task_ptr(std::make_unique<Task>());
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        tasks_.PushBack(std::move(task_ptr));
+        NotifyTask_();
+    }
+
+    template<typename F, typename...Args>
+    auto ThreadPool::AddSyncTask(const ChannelId channel, F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        auto result = task_ptr->SetSyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        PushChannelTask_(channel, std::move(task_ptr));
+        return result;
+    }
+
+    template<typename F, typename...Args>
+    void ThreadPool::AddAsyncTask(const ChannelId channel, F&& job, Args&&... args) {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        PushChannelTask_(channel, std::move(task_ptr));
+    }
+
+    template<typename F, typename...Args>
+    auto ThreadPool::AddSyncTask(const TaskTag tag, F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        auto result = task_ptr->SetSyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        task_ptr->SetTag(tag);
+        tasks_.PushBack(std::move(task_ptr));
+        NotifyTask_();
+        return result;
+    }
+
+    template<typename F, typename...Args>
+    void ThreadPool::AddAsyncTask(const TaskTag tag, F&& job, Args&&... args) {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        task_ptr->SetTag(tag);
+        tasks_.PushBack(std::move(task_ptr));
+        NotifyTask_();
+    }
+
+    template<typename F, typename...Args>
+    auto ThreadPool::AddSyncTask(const time_point_t deadline, F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        auto result = task_ptr->SetSyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        task_ptr->SetDeadline(deadline);
+        tasks_.PushBack(std::move(task_ptr));
+        NotifyTask_();
+        return result;
+    }
+
+    template<typename F, typename...Args>
+    void ThreadPool::AddAsyncTask(const time_point_t deadline, F&& job, Args&&... args) {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
         task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        task_ptr->SetDeadline(deadline);
         tasks_.PushBack(std::move(task_ptr));
-        tasks_available_cv_.notify_one();
+        NotifyTask_();
+    }
+
+    template<typename K, typename F, typename...Args>
+    auto ThreadPool::AddSyncTaskKeyed(const K& key, F&& job, Args&&... args) -> std::shared_future<std::invoke_result_t<F, Args...>> {
+        using return_type = std::invoke_result_t<F, Args...>;
+        const FlightKey flight_key(key, resource_);
+        return flights_.Join<return_type>(flight_key, [&] {
+            // The flight lands only once the promise holds the outcome, so a
+            // Join in between finds the ready future instead of a free key.
+            // The allocator also reaches the promise's shared state.
+            auto promise = std::allocate_shared<std::promise<return_type>>(std::pmr::polymorphic_allocator<std::promise<return_type>>(resource_));
+            std::future<return_type> result = promise->get_future();
+            AddAsyncTask([this, flight_key, promise, bound = std::bind(std::forward<F>(job), std::forward<Args>(args)...)]() mutable {
+                try {
+                    if constexpr (std::is_void_v<return_type>) {
+                        bound();
+                        promise->set_value();
+                    }
+                    else {
+                        promise->set_value(bound());
+                    }
+                }
+                catch (...) {
+                    promise->set_exception(std::current_exception());
+                    flights_.Land(flight_key, false);
+                    return;
+                }
+                flights_.Land(flight_key, true);
+            });
+            return result;
+        });
+    }
+
+    template<typename T, typename F, typename...Args>
+    void ThreadPool::AddSyncTask(CompletionQueue<T>& queue, const std::size_t id, F&& job, Args&&... args) {
+        AddAsyncTask([&queue, id, bound = std::bind(std::forward<F>(job), std::forward<Args>(args)...)]() mutable {
+            queue.Complete(id, bound);
+        });
+    }
+
+    template<typename F, typename...Args>
+    void ThreadPool::AddAsyncTask(const AffinityKey key, F&& job, Args&&... args) {
+        std::unique_ptr<Task> task_ptr(CreateTask_());
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        AddAsyncTask(key, std::move(task_ptr));
+    }
+
+    template<typename F>
+    auto ThreadPool::Blocking(F&& fn) -> std::invoke_result_t<F> {
+        const BlockingScope scope;
+        return std::invoke(std::forward<F>(fn));
+    }
+
+    template<typename F>
+    void ThreadPool::SetWorkerState(F&& factory) {
+        auto state_factory = std::make_shared<const state_factory_t>(
+            [factory = std::forward<F>(factory)](VarNode& state, const std::size_t index) {
+            state.Put(factory(index));
+        });
+        const std::scoped_lock factory_lock(state_factory_mutex_);
+        state_factory_ = std::move(state_factory);
     }
 
 }
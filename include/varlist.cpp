@@ -1,17 +1,51 @@
 #include <varlist.hpp>
 
+#include <new>
+#include <utility>
+#include <algorithm>
+
 namespace vsock {
 
     //////////////////////////////////////////////////////////////////////////////////
     // VarList class defenition
     ////////////////////////////////////////////////////////////////////////////////
 
+    VarList::VarList() :
+        VarList(std::pmr::get_default_resource())
+    {}
+
+    VarList::VarList(std::pmr::memory_resource* resource) :
+        resource_{ resource },
+        nodes_{ nullptr },
+        size_{ 0 },
+        capacity_{ 0 }
+    {}
+
+    VarList::VarList(VarList&& other) noexcept :
+        resource_{ other.resource_ },
+        nodes_{ std::exchange(other.nodes_, nullptr) },
+        size_{ std::exchange(other.size_, 0) },
+        capacity_{ std::exchange(other.capacity_, 0) }
+    {}
+
+    VarList& VarList::operator=(VarList&& rhs) noexcept {
+        if (this != &rhs) {
+            VarList old(std::move(rhs));
+            Swap_(old);
+        }
+        return *this;
+    }
+
+    VarList::~VarList() {
+        Release_();
+    }
+
     void VarList::Remove(std::size_t index) {
         if (index >= size_) {
             throw std::out_of_range("Out of range");
         }
         bool removed{ false };
-        for (auto it = ((nodes_).get() + index); it != ((nodes_).get() + size_); ++it) {
+        for (auto it = (nodes_ + index); it != (nodes_ + size_); ++it) {
             *it = std::move(*(it + 1));
             removed = true;
         }
@@ -24,9 +58,7 @@ namespace vsock {
         if (Empty()) {
             return;
         }
-        nodes_.reset();
-        capacity_ = 0;
-        size_ = 0;
+        Release_();
     }
 
     bool VarList::Empty() const noexcept {
@@ -43,16 +75,40 @@ namespace vsock {
         }
 
         std::size_t future_capacity = std::max(new_capacity, capacity_ * 2);
-        std::unique_ptr<VarNode[]> new_nodes = std::make_unique<VarNode[]>(future_capacity);
+        VarNode* new_nodes = static_cast<VarNode*>(resource_->allocate(sizeof(VarNode) * future_capacity, alignof(VarNode)));
+        for (std::size_t index = 0; index < future_capacity; ++index) {
+            new (new_nodes + index) VarNode(resource_);
+        }
 
-        auto from = new_nodes.get();
-        for (auto it = nodes_.get(); it != (nodes_.get() + size_); ++it, ++from) {
+        auto from = new_nodes;
+        for (auto it = nodes_; it != (nodes_ + size_); ++it, ++from) {
             *from = std::move(*it);
         }
 
+        const std::size_t size = size_;
+        Release_();
+        nodes_ = new_nodes;
         capacity_ = future_capacity;
-        nodes_.reset();
-        nodes_ = std::move(new_nodes);
+        size_ = size;
+    }
+
+    void VarList::Release_() noexcept {
+        if (nodes_) {
+            for (std::size_t index = 0; index < capacity_; ++index) {
+                nodes_[index].~VarNode();
+            }
+            resource_->deallocate(nodes_, sizeof(VarNode) * capacity_, alignof(VarNode));
+        }
+        nodes_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+    }
+
+    void VarList::Swap_(VarList& other) noexcept {
+        std::swap(other.resource_, resource_);
+        std::swap(other.nodes_, nodes_);
+        std::swap(other.size_, size_);
+        std::swap(other.capacity_, capacity_);
     }
 
 }
\ No newline at end of file
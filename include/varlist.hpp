@@ -1,6 +1,8 @@
 #ifndef INCLUDE_GUARD_VARLIST_HPP
 #define INCLUDE_GUARD_VARLIST_HPP
 
+#include <memory_resource>
+
 #include <varnode.hpp>
 
 namespace vsock {
@@ -12,9 +14,14 @@ namespace vsock {
     class VarList {
     public:
 
-        VarList() = default;
-        VarList(VarList&&) = default;
-        VarList& operator=(VarList&&) = default;
+        VarList(const VarList&) = delete;
+        VarList& operator=(const VarList&) = delete;
+
+        VarList();
+        explicit VarList(std::pmr::memory_resource* resource);
+        VarList(VarList&& other) noexcept;
+        VarList& operator=(VarList&& rhs) noexcept;
+        ~VarList();
 
         template<typename T>
         void Add(T&& var);
@@ -36,11 +43,13 @@ namespace vsock {
 
     private:
 
-        std::unique_ptr<VarNode[]> nodes_{ nullptr };
-        std::size_t size_{ 0 };
-        std::size_t capacity_{ 0 };
+        std::pmr::memory_resource* resource_;
+        VarNode* nodes_;
+        std::size_t size_;
+        std::size_t capacity_;
 
         void Resize_(std::size_t new_capacity);
+        void Release_() noexcept;
         void Swap_(VarList& other) noexcept;
 
     };
@@ -52,13 +61,13 @@ namespace vsock {
     template<typename T>
     inline void VarList::Add(T&& var) {
         Resize_(size_ + 1);
-        (nodes_.get() + (size_++))->Put(std::forward<T>(var));
+        (nodes_ + (size_++))->Put(std::forward<T>(var));
     }
 
     template<typename T>
     inline T& VarList::Emplace(T&& var) {
         Resize_(size_ + 1);
-        return (nodes_.get() + (size_++))->Emplace(std::forward<T>(var));
+        return (nodes_ + (size_++))->Emplace(std::forward<T>(var));
     }
 
     template<typename T>
@@ -66,7 +75,7 @@ namespace vsock {
         if (index >= size_) {
             throw std::out_of_range("Out of range");
         }
-        return ((nodes_).get() + index)->Get<T>();
+        return (nodes_ + index)->Get<T>();
     }
 
     template<typename T>
@@ -74,7 +83,7 @@ namespace vsock {
         if (index >= size_) {
             throw std::out_of_range("Out of range");
         }
-        return ((nodes_).get() + index)->Get<T>();
+        return (nodes_ + index)->Get<T>();
     }
 
 }
@@ -7,12 +7,18 @@ namespace vsock {
     ////////////////////////////////////////////////////////////////////////////////
  
     VarNode::VarNode() :
+        VarNode(std::pmr::get_default_resource())
+    {}
+
+    VarNode::VarNode(std::pmr::memory_resource* resource) :
+        resource_{ resource },
         data_{ nullptr },
         delete_fnc_{ nullptr },
         hash_code_{ 0 }
     {}
 
     VarNode::VarNode(VarNode&& other) :
+        resource_{ other.resource_ },
         data_{ std::exchange(other.data_,nullptr) },
         delete_fnc_{ std::exchange(other.delete_fnc_,nullptr) },
         hash_code_{ std::exchange(other.hash_code_,0) }
@@ -34,7 +40,7 @@ namespace vsock {
         if (Empty()) {
             return;
         }
-        delete_fnc_(data_);
+        delete_fnc_(data_, resource_);
         data_ = nullptr;
         delete_fnc_ = nullptr;
         hash_code_ = 0;
@@ -45,6 +51,7 @@ namespace vsock {
     }
 
     void VarNode::Swap_(VarNode& other) noexcept {
+        std::swap(other.resource_, resource_);
         std::swap(other.data_, data_);
         std::swap(other.delete_fnc_, delete_fnc_);
         std::swap(other.hash_code_, hash_code_);
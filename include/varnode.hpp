@@ -1,9 +1,11 @@
 #ifndef INCLUDE_GUARD_VARNODE_HPP
 #define INCLUDE_GUARD_VARNODE_HPP
 
+#include <new>
 #include <utility>
 #include <memory>
 #include <stdexcept>
+#include <memory_resource>
 
 namespace vsock {
 
@@ -20,6 +22,7 @@ namespace vsock {
     public:
 
         VarNode();
+        explicit VarNode(std::pmr::memory_resource* resource);
         VarNode(VarNode&& other);
         VarNode& operator=(VarNode&& rhs);
         ~VarNode();
@@ -48,14 +51,15 @@ namespace vsock {
         void* Put_(T&& data);
 
         template<typename T>
-        static void Delete_(void* ptr);
+        static void Delete_(void* ptr, std::pmr::memory_resource* resource);
 
         void Swap_(VarNode& other) noexcept;
 
     private:
 
+        std::pmr::memory_resource* resource_;
         void* data_;
-        void (*delete_fnc_)(void*);
+        void (*delete_fnc_)(void*, std::pmr::memory_resource*);
         std::size_t hash_code_;
 
     };
@@ -66,8 +70,10 @@ namespace vsock {
 
     template<typename T>
     VarNode::VarNode(T&& data) :
-        data_{ Put_(std::forward<T>(data)) }
-    {}
+        VarNode()
+    {
+        Put(std::forward<T>(data));
+    }
 
     template<typename T>
     inline void VarNode::Put(T&& data) {
@@ -98,7 +104,14 @@ namespace vsock {
 
     template<typename T>
     inline void* VarNode::Put_(T&& data) {
-        void* result = reinterpret_cast<void*>(new T(std::forward<T>(data)));
+        void* result = resource_->allocate(sizeof(T), alignof(T));
+        try {
+            new (result) T(std::forward<T>(data));
+        }
+        catch (...) {
+            resource_->deallocate(result, sizeof(T), alignof(T));
+            throw;
+        }
         Drop();
         hash_code_ = typeid(T).hash_code();
         delete_fnc_ = VarNode::Delete_<T>;
@@ -106,9 +119,9 @@ namespace vsock {
     }
 
     template<typename T>
-    inline void VarNode::Delete_(void* ptr) {
-        delete reinterpret_cast<T*>(ptr);
-        ptr = nullptr;
+    inline void VarNode::Delete_(void* ptr, std::pmr::memory_resource* resource) {
+        reinterpret_cast<T*>(ptr)->~T();
+        resource->deallocate(ptr, sizeof(T), alignof(T));
     }
 
 }
@@ -0,0 +1,186 @@
+#include <worker.hpp>
+#include <threadpool.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ScratchArena class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ScratchArena::ScratchArena() :
+        ScratchArena(DEFAULT_BLOCK_SIZE)
+    {}
+
+    ScratchArena::ScratchArena(const std::size_t block_size) :
+        ScratchArena(block_size, std::pmr::get_default_resource())
+    {}
+
+    ScratchArena::ScratchArena(const std::size_t block_size, std::pmr::memory_resource* resource) :
+        resource_{ resource },
+        blocks_{ resource },
+        block_size_{ std::max<std::size_t>(block_size, alignof(std::max_align_t)) },
+        current_{ 0 },
+        offset_{ 0 },
+        used_{ 0 }
+    {}
+
+    ScratchArena::ScratchArena(ScratchArena&& other) noexcept :
+        resource_{ other.resource_ },
+        blocks_{ std::move(other.blocks_) },
+        block_size_{ other.block_size_ },
+        current_{ std::exchange(other.current_, 0) },
+        offset_{ std::exchange(other.offset_, 0) },
+        used_{ std::exchange(other.used_, 0) }
+    {}
+
+    ScratchArena& ScratchArena::operator=(ScratchArena&& rhs) noexcept {
+        if (this != &rhs) {
+            Release_();
+            resource_ = rhs.resource_;
+            blocks_ = std::move(rhs.blocks_);
+            rhs.blocks_.clear();
+            block_size_ = rhs.block_size_;
+            current_ = std::exchange(rhs.current_, 0);
+            offset_ = std::exchange(rhs.offset_, 0);
+            used_ = std::exchange(rhs.used_, 0);
+        }
+        return *this;
+    }
+
+    ScratchArena::~ScratchArena() {
+        Release_();
+    }
+
+    void* ScratchArena::Allocate(const std::size_t size, const std::size_t alignment) {
+        while (current_ < blocks_.size()) {
+            Block& block = blocks_[current_];
+            const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data);
+            const std::size_t aligned = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+            if (aligned + size <= block.size) {
+                offset_ = aligned + size;
+                used_ += size;
+                return block.data + aligned;
+            }
+            ++current_;
+            offset_ = 0;
+        }
+        AddBlock_(size + alignment);
+        return Allocate(size, alignment);
+    }
+
+    void ScratchArena::Reset() noexcept {
+        current_ = 0;
+        offset_ = 0;
+        used_ = 0;
+    }
+
+    ScratchArena::Marker ScratchArena::Mark() const noexcept {
+        return Marker{ current_, offset_, used_ };
+    }
+
+    void ScratchArena::Rewind(const Marker& marker) noexcept {
+        current_ = marker.block;
+        offset_ = marker.offset;
+        used_ = marker.used;
+    }
+
+    std::size_t ScratchArena::Used() const noexcept {
+        return used_;
+    }
+
+    std::size_t ScratchArena::Capacity() const noexcept {
+        std::size_t capacity{ 0 };
+        for (const Block& block : blocks_) {
+            capacity += block.size;
+        }
+        return capacity;
+    }
+
+    void ScratchArena::AddBlock_(const std::size_t min_size) {
+        const std::size_t size = std::max(block_size_, min_size);
+        std::byte* data = static_cast<std::byte*>(resource_->allocate(size, alignof(std::max_align_t)));
+        try {
+            blocks_.push_back(Block{ data, size });
+        }
+        catch (...) {
+            resource_->deallocate(data, size, alignof(std::max_align_t));
+            throw;
+        }
+        current_ = blocks_.size() - 1;
+        offset_ = 0;
+    }
+
+    void ScratchArena::Release_() noexcept {
+        for (const Block& block : blocks_) {
+            resource_->deallocate(block.data, block.size, alignof(std::max_align_t));
+        }
+        blocks_.clear();
+        current_ = 0;
+        offset_ = 0;
+        used_ = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // WorkerContext class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    thread_local WorkerContext* WorkerContext::current_{ nullptr };
+
+    WorkerContext::WorkerContext() :
+        WorkerContext(std::pmr::get_default_resource())
+    {}
+
+    WorkerContext::WorkerContext(std::pmr::memory_resource* resource) :
+        index_{ 0 },
+        pool_{ nullptr },
+        scratch_{ ScratchArena::DEFAULT_BLOCK_SIZE, resource },
+        state_{ resource },
+        blocking_{ 0 },
+        wake_{ },
+        parked_{ false },
+        budgeted_{ false },
+        budget_lent_{ false },
+        busy_since_{ 0 },
+        stalled_{ false },
+        spawns_{ },
+        tags_{ },
+        tracing_{ 0 },
+        trace_mutex_{ },
+        traced_{ resource },
+        batch_mutex_{ },
+        batch_{ resource },
+        batch_origin_{ nullptr },
+        lent_{ false }
+    {}
+
+    std::size_t WorkerContext::Index() const noexcept {
+        return index_;
+    }
+
+    ThreadPool* WorkerContext::Pool() const noexcept {
+        return pool_;
+    }
+
+    ScratchArena& WorkerContext::Scratch() noexcept {
+        return scratch_;
+    }
+
+    bool WorkerContext::HasState() const noexcept {
+        return !state_.Empty();
+    }
+
+    WorkerContext* WorkerContext::Current() noexcept {
+        return current_;
+    }
+
+    void WorkerContext::EnsureState_() {
+        if (state_.Empty() && pool_) {
+            pool_->CreateWorkerState_(*this);
+        }
+    }
+
+}
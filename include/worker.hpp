@@ -0,0 +1,178 @@
+#ifndef INCLUDE_GUARD_WORKER_HPP
+#define INCLUDE_GUARD_WORKER_HPP
+
+#include <cstddef>
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <type_traits>
+#include <memory_resource>
+
+#include <task.hpp>
+#include <varnode.hpp>
+#include <spawn_deque.hpp>
+#include <task_tag.hpp>
+#include <task_trace.hpp>
+
+namespace vsock {
+
+    class ThreadPool;
+    class TaskQueue;
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ScratchArena class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class ScratchArena {
+    public:
+
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+
+    public:
+
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE{ 64 * 1024 };
+
+        struct Marker {
+            std::size_t block;
+            std::size_t offset;
+            std::size_t used;
+        };
+
+        ScratchArena();
+        ScratchArena(const std::size_t block_size);
+        ScratchArena(const std::size_t block_size, std::pmr::memory_resource* resource);
+        ScratchArena(ScratchArena&& other) noexcept;
+        ScratchArena& operator=(ScratchArena&& rhs) noexcept;
+        ~ScratchArena();
+
+        void* Allocate(const std::size_t size, const std::size_t alignment = alignof(std::max_align_t));
+
+        template<typename T>
+        T* Allocate(const std::size_t count);
+
+        template<typename T, typename... Args>
+        T* Create(Args&&... args);
+
+        void Reset() noexcept;
+        Marker Mark() const noexcept;
+        void Rewind(const Marker& marker) noexcept;
+        std::size_t Used() const noexcept;
+        std::size_t Capacity() const noexcept;
+
+    private:
+
+        struct Block {
+            std::byte* data;
+            std::size_t size;
+        };
+
+        std::pmr::memory_resource* resource_;
+        std::pmr::vector<Block> blocks_;
+        std::size_t block_size_;
+        std::size_t current_;
+        std::size_t offset_;
+        std::size_t used_;
+
+        void AddBlock_(const std::size_t min_size);
+        void Release_() noexcept;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // WorkerContext class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class WorkerContext {
+    public:
+
+        WorkerContext(const WorkerContext&) = delete;
+        WorkerContext& operator=(const WorkerContext&) = delete;
+
+    public:
+
+        WorkerContext();
+        explicit WorkerContext(std::pmr::memory_resource* resource);
+
+        std::size_t Index() const noexcept;
+        ThreadPool* Pool() const noexcept;
+        ScratchArena& Scratch() noexcept;
+
+        template<typename T>
+        T& State();
+
+        bool HasState() const noexcept;
+
+        static WorkerContext* Current() noexcept;
+
+    private:
+
+        friend class ThreadPool;
+        friend class ShardedPool;
+        friend class SpawnScope;
+
+        static thread_local WorkerContext* current_;
+
+        std::size_t index_;
+        ThreadPool* pool_;
+        ScratchArena scratch_;
+        VarNode state_;
+        std::size_t blocking_;
+        // Parked workers sleep on their own condvar, so the pool can wake
+        // exactly the one a keyed task was queued for.
+        std::condition_variable wake_;
+        bool parked_;
+        bool budgeted_;
+        bool budget_lent_;
+        std::atomic<std::int64_t> busy_since_;
+        std::atomic_bool stalled_;
+        SpawnDeque spawns_;
+        TagTable tags_;
+        // Trace id of the task running here while the pool records.
+        std::uint64_t tracing_;
+        std::mutex trace_mutex_;
+        std::pmr::vector<TaskTrace::Record> traced_;
+        // Tasks dequeued in one go. While lent, workers that run dry take
+        // from the back, so a blocked task never strands the rest.
+        std::mutex batch_mutex_;
+        std::pmr::deque<std::unique_ptr<Task>> batch_;
+        TaskQueue* batch_origin_;
+        bool lent_;
+
+        void EnsureState_();
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ScratchArena class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    inline T* ScratchArena::Allocate(const std::size_t count) {
+        return reinterpret_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    template<typename T, typename... Args>
+    inline T* ScratchArena::Create(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // WorkerContext class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    inline T& WorkerContext::State() {
+        EnsureState_();
+        return state_.Get<T>();
+    }
+
+}
+
+#endif // INCLUDE_GUARD_WORKER_HPP
@@ -0,0 +1,270 @@
+#include <worker_thread.hpp>
+
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <exception>
+#include <algorithm>
+#include <system_error>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <vector>
+#endif
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // WorkerThread class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+#if defined(_WIN32)
+
+    WorkerThread::WorkerThread() noexcept :
+        thread_{ },
+        stack_size_{ 0 }
+    {}
+
+    WorkerThread::WorkerThread(const Stack& stack, std::function<void()> entry) :
+        thread_{ std::move(entry) },
+        stack_size_{ stack.size }
+    {}
+
+    WorkerThread::WorkerThread(WorkerThread&& other) noexcept :
+        thread_{ std::move(other.thread_) },
+        stack_size_{ std::exchange(other.stack_size_, 0) }
+    {}
+
+    WorkerThread& WorkerThread::operator=(WorkerThread&& rhs) noexcept {
+        if (this != &rhs) {
+            thread_ = std::move(rhs.thread_);
+            stack_size_ = std::exchange(rhs.stack_size_, 0);
+        }
+        return *this;
+    }
+
+    WorkerThread::~WorkerThread() = default;
+
+    bool WorkerThread::Joinable() const noexcept {
+        return thread_.joinable();
+    }
+
+    void WorkerThread::Join() {
+        thread_.join();
+    }
+
+    std::size_t WorkerThread::StackReserved() const noexcept {
+        return Joinable() ? stack_size_ : 0;
+    }
+
+    std::size_t WorkerThread::StackResident() const noexcept {
+        return 0;
+    }
+
+#else
+
+    WorkerThread::WorkerThread() noexcept :
+        handle_{ },
+        joinable_{ false },
+        mapping_{ nullptr },
+        mapping_size_{ 0 },
+        stack_{ nullptr },
+        stack_size_{ 0 }
+    {}
+
+    WorkerThread::WorkerThread(const Stack& stack, std::function<void()> entry) :
+        WorkerThread()
+    {
+        auto owned = std::make_unique<std::function<void()>>(std::move(entry));
+        Start_(stack, owned.get());
+        owned.release();
+    }
+
+    WorkerThread::WorkerThread(WorkerThread&& other) noexcept :
+        handle_{ other.handle_ },
+        joinable_{ std::exchange(other.joinable_, false) },
+        mapping_{ std::exchange(other.mapping_, nullptr) },
+        mapping_size_{ std::exchange(other.mapping_size_, 0) },
+        stack_{ std::exchange(other.stack_, nullptr) },
+        stack_size_{ std::exchange(other.stack_size_, 0) }
+    {}
+
+    WorkerThread& WorkerThread::operator=(WorkerThread&& rhs) noexcept {
+        if (this != &rhs) {
+            if (joinable_) {
+                std::terminate();
+            }
+            UnmapStack_();
+            handle_ = rhs.handle_;
+            joinable_ = std::exchange(rhs.joinable_, false);
+            mapping_ = std::exchange(rhs.mapping_, nullptr);
+            mapping_size_ = std::exchange(rhs.mapping_size_, 0);
+            stack_ = std::exchange(rhs.stack_, nullptr);
+            stack_size_ = std::exchange(rhs.stack_size_, 0);
+        }
+        return *this;
+    }
+
+    WorkerThread::~WorkerThread() {
+        if (joinable_) {
+            std::terminate();
+        }
+        UnmapStack_();
+    }
+
+    bool WorkerThread::Joinable() const noexcept {
+        return joinable_;
+    }
+
+    void WorkerThread::Join() {
+        if (!joinable_) {
+            throw std::system_error(std::make_error_code(std::errc::invalid_argument), "WorkerThread is not joinable");
+        }
+        if (const int error = pthread_join(handle_, nullptr); error != 0) {
+            throw std::system_error(error, std::generic_category(), "pthread_join");
+        }
+        joinable_ = false;
+        UnmapStack_();
+        stack_ = nullptr;
+        stack_size_ = 0;
+    }
+
+    std::size_t WorkerThread::StackReserved() const noexcept {
+        return stack_size_;
+    }
+
+    std::size_t WorkerThread::StackResident() const noexcept {
+#if defined(__linux__)
+        if (!stack_ || stack_size_ == 0) {
+            return 0;
+        }
+        const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(stack_) & ~(page - 1);
+        const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(stack_) + stack_size_;
+        const std::size_t pages = (end - begin + page - 1) / page;
+        std::vector<unsigned char> resident;
+        try {
+            resident.resize(pages);
+        }
+        catch (...) {
+            return 0;
+        }
+        if (mincore(reinterpret_cast<void*>(begin), end - begin, resident.data()) != 0) {
+            return 0;
+        }
+        return page * static_cast<std::size_t>(std::count_if(resident.begin(), resident.end(),
+            [](const unsigned char flags) { return (flags & 1) != 0; }));
+#else
+        return 0;
+#endif
+    }
+
+    void WorkerThread::Start_(const Stack& stack, std::function<void()>* entry) {
+        pthread_attr_t attr;
+        if (const int error = pthread_attr_init(&attr); error != 0) {
+            throw std::system_error(error, std::generic_category(), "pthread_attr_init");
+        }
+        try {
+            if (stack.prefault || stack.huge_pages) {
+                MapStack_(stack, attr);
+            }
+            else if (stack.size > 0) {
+                const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+                const std::size_t size = (std::max<std::size_t>(stack.size, PTHREAD_STACK_MIN) + page - 1) & ~(page - 1);
+                if (const int error = pthread_attr_setstacksize(&attr, size); error != 0) {
+                    throw std::system_error(error, std::generic_category(), "pthread_attr_setstacksize");
+                }
+            }
+            if (const int error = pthread_create(&handle_, &attr, &WorkerThread::Run_, entry); error != 0) {
+                throw std::system_error(error, std::generic_category(), "pthread_create");
+            }
+        }
+        catch (...) {
+            pthread_attr_destroy(&attr);
+            UnmapStack_();
+            throw;
+        }
+#if !defined(__linux__)
+        if (!mapping_) {
+            pthread_attr_getstacksize(&attr, &stack_size_);
+        }
+#endif
+        pthread_attr_destroy(&attr);
+        joinable_ = true;
+
+#if defined(__linux__)
+        if (!mapping_) {
+            pthread_attr_t actual;
+            if (pthread_getattr_np(handle_, &actual) == 0) {
+                pthread_attr_getstack(&actual, &stack_, &stack_size_);
+                pthread_attr_destroy(&actual);
+            }
+        }
+#endif
+    }
+
+    void WorkerThread::MapStack_(const Stack& stack, pthread_attr_t& attr) {
+        std::size_t size = stack.size;
+        if (size == 0 && pthread_attr_getstacksize(&attr, &size) != 0) {
+            size = 0;
+        }
+        const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const std::size_t granule = stack.huge_pages ? HUGE_PAGE_SIZE : page;
+        size = (std::max<std::size_t>(size, PTHREAD_STACK_MIN) + granule - 1) & ~(granule - 1);
+
+        // One inaccessible guard page below the stack; a huge page mapping
+        // is over-allocated so the stack itself can start on a huge page.
+        const std::size_t slack = stack.huge_pages ? HUGE_PAGE_SIZE : 0;
+        mapping_size_ = page + size + slack;
+        void* mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+        if (mapping == MAP_FAILED) {
+            mapping_size_ = 0;
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+        mapping_ = mapping;
+        const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(mapping_) + page;
+        std::byte* base = reinterpret_cast<std::byte*>((start + granule - 1) & ~(granule - 1));
+        if (mprotect(base - page, page, PROT_NONE) != 0) {
+            throw std::system_error(errno, std::generic_category(), "mprotect");
+        }
+#if defined(__linux__)
+        if (stack.huge_pages) {
+            // Best effort: without THP support the stack stays on small pages.
+            madvise(base, size, MADV_HUGEPAGE);
+        }
+#endif
+        if (stack.prefault) {
+            for (std::size_t offset = 0; offset < size; offset += page) {
+                static_cast<volatile std::byte*>(base)[offset] = std::byte{ 0 };
+            }
+        }
+        if (const int error = pthread_attr_setstack(&attr, base, size); error != 0) {
+            throw std::system_error(error, std::generic_category(), "pthread_attr_setstack");
+        }
+        stack_ = base;
+        stack_size_ = size;
+    }
+
+    void WorkerThread::UnmapStack_() noexcept {
+        if (mapping_) {
+            munmap(mapping_, mapping_size_);
+            mapping_ = nullptr;
+            mapping_size_ = 0;
+        }
+    }
+
+    void* WorkerThread::Run_(void* entry) noexcept {
+        const std::unique_ptr<std::function<void()>> owned(static_cast<std::function<void()>*>(entry));
+        (*owned)();
+        return nullptr;
+    }
+
+#endif
+
+}
@@ -0,0 +1,77 @@
+#ifndef INCLUDE_GUARD_WORKER_THREAD_HPP
+#define INCLUDE_GUARD_WORKER_THREAD_HPP
+
+#include <cstddef>
+#include <functional>
+
+#if defined(_WIN32)
+#include <thread>
+#else
+#include <pthread.h>
+#endif
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // WorkerThread class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Joinable thread created through the native API so the stack can be sized
+    // and, on Linux, mapped by the pool itself to be pre-faulted or backed by
+    // transparent huge pages. Like std::thread, it must be joined before it is
+    // destroyed or assigned to.
+
+    class WorkerThread {
+    public:
+
+        WorkerThread(const WorkerThread&) = delete;
+        WorkerThread& operator=(const WorkerThread&) = delete;
+
+    public:
+
+        static constexpr std::size_t HUGE_PAGE_SIZE{ 2 * 1024 * 1024 };
+
+        struct Stack {
+            // 0 keeps the platform default (RLIMIT_STACK for glibc).
+            std::size_t size{ 0 };
+            bool prefault{ false };
+            bool huge_pages{ false };
+        };
+
+        WorkerThread() noexcept;
+        WorkerThread(const Stack& stack, std::function<void()> entry);
+        WorkerThread(WorkerThread&& other) noexcept;
+        WorkerThread& operator=(WorkerThread&& rhs) noexcept;
+        ~WorkerThread();
+
+        bool Joinable() const noexcept;
+        void Join();
+
+        std::size_t StackReserved() const noexcept;
+        std::size_t StackResident() const noexcept;
+
+    private:
+
+#if defined(_WIN32)
+        std::thread thread_;
+#else
+        pthread_t handle_;
+        bool joinable_;
+        void* mapping_;
+        std::size_t mapping_size_;
+        void* stack_;
+#endif
+        std::size_t stack_size_;
+
+#if !defined(_WIN32)
+        void Start_(const Stack& stack, std::function<void()>* entry);
+        void MapStack_(const Stack& stack, pthread_attr_t& attr);
+        void UnmapStack_() noexcept;
+        static void* Run_(void* entry) noexcept;
+#endif
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_WORKER_THREAD_HPP
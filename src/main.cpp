@@ -1,5 +1,6 @@
 #include <atomic>
 #include <numeric>
+#include <algorithm>
 #include <string>
 #include <thread>
 #include <cstddef>
@@ -7,10 +8,30 @@
 #include <iostream>
 #include <random>
 #include <list>
+#include <set>
 #include <mutex>
+#include <memory_resource>
 #include <threadpool.hpp>
+#include <basic_threadpool.hpp>
+#include <sharded_pool.hpp>
+#include <parallel.hpp>
+#include <scheduler.hpp>
+#include <strand.hpp>
+#include <pipeline.hpp>
+#include <channel.hpp>
 #include <queue.hpp>
 #include <varlist.hpp>
+#include <future>
+#include <system_error>
+#include <cerrno>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
 
 using namespace std;
 using namespace vsock;
@@ -42,6 +63,18 @@ std::size_t HardTest2(std::size_t size) {
     return primes;
 }
 
+long Fibonacci(const int n) {
+    if (n < 2) {
+        return n;
+    }
+    long left{ 0 };
+    SpawnScope scope;
+    scope.Spawn([&left, n] { left = Fibonacci(n - 1); });
+    const long right = Fibonacci(n - 2);
+    scope.Sync();
+    return left + right;
+}
+
 bool HardTest1(std::size_t size) {
     std::vector<int> arr(size);
     std::iota(arr.begin(), arr.end(), 1);
@@ -85,6 +118,95 @@ void PrintTask(const int sleep_from, const int sleep_to) {
     mtx_.unlock();
 }
 
+// Forwards to the default resource and counts what passes through.
+class CountingResource : public std::pmr::memory_resource {
+public:
+
+    std::size_t Allocations() const noexcept {
+        return allocations_.load();
+    }
+
+    std::size_t BytesInUse() const noexcept {
+        return bytes_.load();
+    }
+
+private:
+
+    std::atomic<std::size_t> allocations_{ 0 };
+    std::atomic<std::size_t> bytes_{ 0 };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations_;
+        bytes_ += bytes;
+        return std::pmr::get_default_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        bytes_ -= bytes;
+        std::pmr::get_default_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+};
+
+// Runs 100 sync tasks, then leaves 50 slow async tasks queued for the
+// destroy policy: SmoothDestroy runs them all, SharpDestroy drops the rest.
+template<typename Q, typename W, typename A, typename M, typename D>
+void BasicPoolDemo(const std::string& name) {
+    std::atomic<std::size_t> ran{ 0 };
+    std::size_t sum{ 0 };
+    {
+        BasicThreadPool<Q, W, A, M, D> basic_pool(2);
+        std::vector<std::future<std::size_t>> results;
+        for (std::size_t z = 0; z < 100; ++z) {
+            results.push_back(basic_pool.AddSyncTask([z] { return z; }));
+        }
+        for (std::future<std::size_t>& result : results) {
+            sum += result.get();
+        }
+        for (int z = 0; z < 50; ++z) {
+            basic_pool.AddAsyncTask([&ran] {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                ran.fetch_add(1);
+            });
+        }
+        if constexpr (std::is_same_v<M, CountingMetrics>) {
+            cout << name << ": submitted " << basic_pool.Metrics().Submitted() << ", ";
+        }
+        else {
+            cout << name << ": ";
+        }
+    }
+    cout << "sum " << sum << ", tail ran " << (std::is_same_v<D, SmoothDestroy> ? (ran == 50 ? "all" : "some") : (ran <= 50 ? "<= 50" : "too many")) << '\n';
+}
+
+template<typename Q, typename W, typename A, typename M>
+void BasicPoolDemo(const std::string& name) {
+    BasicPoolDemo<Q, W, A, M, SmoothDestroy>(name + "/smooth");
+    BasicPoolDemo<Q, W, A, M, SharpDestroy>(name + "/sharp");
+}
+
+template<typename Q, typename W, typename A>
+void BasicPoolDemo(const std::string& name) {
+    BasicPoolDemo<Q, W, A, NoMetrics>(name + "/nometrics");
+    BasicPoolDemo<Q, W, A, CountingMetrics>(name + "/counting");
+}
+
+template<typename Q, typename W>
+void BasicPoolDemo(const std::string& name) {
+    BasicPoolDemo<Q, W, HeapAlloc>(name + "/heap");
+    BasicPoolDemo<Q, W, PoolAlloc>(name + "/pool");
+}
+
+template<typename Q>
+void BasicPoolDemo(const std::string& name) {
+    BasicPoolDemo<Q, CondVarWait>(name + "/condvar");
+    BasicPoolDemo<Q, SpinWait>(name + "/spin");
+}
+
 void RunTests() {
     cout << "\n=========================================================================\n"s;
     ThreadPool pool;
@@ -434,6 +556,730 @@ void RunTests() {
         cout << "outside val: " << val << '\n';
     }
 
+    {
+        cout << "Test #W1: -------------------\n";
+        pool.SetWorkerState([](std::size_t index) {
+            return "worker #"s + std::to_string(index);
+        });
+        for (int z = 0; z < 10; ++z) {
+            pool.AddAsyncTask([](int id) {
+                WorkerContext* worker = ThreadPool::CurrentWorker();
+                int* buf = worker->Scratch().Allocate<int>(1024);
+                buf[0] = id;
+                mtx_.lock();
+                cout << "task #" << buf[0] << " runs on " << worker->State<std::string>() << '\n';
+                mtx_.unlock();
+            }, z);
+        }
+        pool.Wait();
+    }
+
+    {
+        cout << "Test #B2: -------------------\n";
+        // One worker waits on work queued behind it. ThreadPool::Blocking
+        // tells the pool up front; a spare takes over the queue meanwhile.
+        ThreadPool single_pool(1);
+        auto outer = single_pool.AddSyncTask([&single_pool] {
+            auto inner = single_pool.AddSyncTask([] { return 6 * 7; });
+            return ThreadPool::Blocking([&inner] { return inner.get(); });
+        });
+        cout << "explicit blocking: " << outer.get() << '\n';
+
+        // The same wait without the hint: the stall watchdog notices the
+        // worker has been busy past stall_threshold and starts a spare.
+        ThreadPool::Config config;
+        config.concurency = 1;
+        config.stall_threshold = std::chrono::milliseconds(50);
+        ThreadPool watched_pool(config);
+        auto stalled = watched_pool.AddSyncTask([&watched_pool] {
+            auto inner = watched_pool.AddSyncTask([] { return 6 * 7; });
+            return inner.get();
+        });
+        cout << "watchdog compensation: " << stalled.get() << '\n';
+    }
+
+    {
+        cout << "Test #A1: -------------------\n";
+        ThreadPool keyed_pool(4);
+        std::mutex seen_mutex;
+        std::vector<std::set<std::size_t>> seen(8);
+        for (int z = 0; z < 400; ++z) {
+            keyed_pool.AddAsyncTask(AffinityKey(z % 8), [&seen, &seen_mutex](int key) {
+                HardTest2(200);
+                const std::scoped_lock seen_lock(seen_mutex);
+                seen[key].insert(ThreadPool::CurrentWorker()->Index());
+            }, z % 8);
+        }
+        keyed_pool.Wait();
+        bool pinned{ true };
+        for (const std::set<std::size_t>& workers : seen) {
+            pinned = pinned && workers.size() == 1;
+        }
+        cout << "every key ran on a single worker: " << pinned << '\n';
+
+        std::atomic<int> inside{ 0 };
+        std::atomic<int> overlaps{ 0 };
+        for (int z = 0; z < 400; ++z) {
+            keyed_pool.AddAsyncTask(AffinityKey(z % 2 ? z : 0), [&inside, &overlaps](bool hot) {
+                if (hot && inside.fetch_add(1) != 0) {
+                    ++overlaps;
+                }
+                HardTest2(200);
+                if (hot) {
+                    inside.fetch_sub(1);
+                }
+            }, z % 2 == 0);
+            if (z % 25 == 0) {
+                keyed_pool.RebalanceAffinity();
+            }
+        }
+        keyed_pool.Wait();
+        cout << "hot key overlaps while rebalancing: " << overlaps << '\n';
+
+        keyed_pool.SetWorkStealing(true);
+        std::set<std::size_t> thieves;
+        for (int z = 0; z < 200; ++z) {
+            keyed_pool.AddAsyncTask(AffinityKey(0), [&] {
+                HardTest2(500);
+                const std::scoped_lock seen_lock(seen_mutex);
+                thieves.insert(ThreadPool::CurrentWorker()->Index());
+            });
+        }
+        keyed_pool.Wait();
+        cout << "with stealing key 0 ran on " << thieves.size() << " worker(s)\n";
+    }
+
+    {
+        cout << "Test #S1: -------------------\n";
+        Strand strand(pool);
+        std::vector<int> order;
+        for (int z = 0; z < 20; ++z) {
+            strand.AddAsyncTask([](std::vector<int>& o, int id) {
+                o.push_back(id);
+            }, std::ref(order), z);
+        }
+        auto size = strand.AddSyncTask([](const std::vector<int>& o) {
+            return o.size();
+        }, std::cref(order));
+        cout << "strand processed " << size.get() << " tasks in order: " << std::is_sorted(order.begin(), order.end()) << '\n';
+        pool.Wait();
+    }
+
+    {
+        cout << "Test #C1: -------------------\n";
+        CompletionQueue<std::size_t> results;
+        const std::size_t count{ 20 };
+        for (std::size_t z = 0; z < count; ++z) {
+            std::uniform_int_distribution<std::mt19937::result_type> size(10, 30000);
+            pool.AddSyncTask(results, z, HardTest2, size(rng));
+        }
+        for (std::size_t z = 0; z < count; ++z) {
+            auto result = results.Pop();
+            mtx_.lock();
+            cout << "result #" << result.id << " is ready with value " << result.Get() << "\n";
+            mtx_.unlock();
+        }
+        pool.Wait();
+    }
+
+    {
+        cout << "Test #P1: -------------------\n";
+        Pipeline pipeline(pool, 8);
+        std::size_t next{ 0 };
+        pipeline.AddStage(Pipeline::StageType::PARALLEL, [](VarNode& item) {
+            item.Put(HardTest2(item.Get<std::size_t>()));
+        }).AddStage(Pipeline::StageType::SERIAL, [](VarNode& item) {
+            cout << "primes: " << item.Get<std::size_t>() << '\n';
+        });
+        pipeline.Run([&next](VarNode& item) {
+            if (next == 10) {
+                return false;
+            }
+            item.Put(std::size_t{ 1000 } * ++next);
+            return true;
+        });
+    }
+
+    {
+        cout << "Test #CH1: ------------------\n";
+        Channel<std::string> channel(pool, 4);
+        auto consumed = channel.ForEach([](const std::string& line) {
+            mtx_.lock();
+            cout << "received: " << line << '\n';
+            mtx_.unlock();
+        }, 2);
+        for (int z = 0; z < 8; ++z) {
+            channel.Send("line #"s + std::to_string(z));
+        }
+        channel.Close();
+        consumed.get();
+    }
+
+    {
+        cout << "Test #F1: ------------------\n";
+        auto fib = pool.AddSyncTask(Fibonacci, 25);
+        cout << "fibonacci(25) = " << fib.get() << '\n';
+    }
+
+    {
+        cout << "Test #M1: ------------------\n";
+        ThreadPool::Config config;
+        config.concurency = 4;
+        config.stack.size = 256 * 1024;
+        ThreadPool small_pool(config);
+        const ThreadPool::Footprint footprint = small_pool.MemoryFootprint();
+        cout << "threads: " << footprint.threads << ", stacks reserved: " << footprint.stack_reserved / 1024 << " KiB\n";
+    }
+
+    {
+        cout << "Test #K1: ------------------\n";
+        std::vector<std::shared_future<std::size_t>> primes;
+        for (int z = 0; z < 8; ++z) {
+            primes.push_back(pool.AddSyncTaskKeyed(z % 2, HardTest2, 2000 + z % 2));
+        }
+        for (std::shared_future<std::size_t>& result : primes) {
+            cout << result.get() << ' ';
+        }
+        cout << '\n';
+    }
+
+    {
+        cout << "Test #R1: ------------------\n";
+        pool.StartRecording();
+        for (int z = 0; z < 4; ++z) {
+            pool.AddAsyncTask([&pool, z] {
+                HardTest2(1000 + z * 500);
+                pool.AddAsyncTask([] { HardTest2(500); });
+            });
+        }
+        pool.Wait();
+        const TaskTrace trace = pool.StopRecording();
+        for (const TaskTrace::Record& record : trace.Records()) {
+            cout << "task " << record.id << " parent " << record.parent << ": " << record.duration / 1000 << " us\n";
+        }
+    }
+
+#if defined(__linux__)
+    {
+        cout << "Test #E1: ------------------\n";
+        ThreadPool io_pool(2);
+
+        // Pipe: a read event, then a hangup once the writer closes; the
+        // handler unwatches its own descriptor on hangup.
+        int pipe_fds[2];
+        if (::pipe(pipe_fds) != 0) {
+            throw std::system_error(errno, std::generic_category(), "pipe");
+        }
+        std::promise<std::string> pipe_data;
+        std::promise<void> pipe_hangup;
+        std::string pipe_buffer;
+        io_pool.WatchDescriptor(pipe_fds[0], Reactor::EVENT_READ, [&](int fd, std::uint32_t events) {
+            char chunk[64];
+            const ssize_t count = (events & Reactor::EVENT_READ) ? ::read(fd, chunk, sizeof(chunk)) : 0;
+            if (count > 0) {
+                pipe_buffer.append(chunk, static_cast<std::size_t>(count));
+                if (pipe_buffer.size() == 4) {
+                    pipe_data.set_value(pipe_buffer);
+                }
+            }
+            else if (count == 0 || (events & Reactor::EVENT_ERROR)) {
+                io_pool.UnwatchDescriptor(fd);
+                pipe_hangup.set_value();
+            }
+        });
+        [[maybe_unused]] const ssize_t written = ::write(pipe_fds[1], "ping", 4);
+        cout << "pipe read: " << pipe_data.get_future().get() << '\n';
+        ::close(pipe_fds[1]);
+        pipe_hangup.get_future().get();
+        cout << "pipe hangup handled\n";
+        ::close(pipe_fds[0]);
+
+        // Loopback TCP pair: the client side waits for a write event, the
+        // server side reads until the peer shuts down.
+        const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (listener < 0
+            || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listener, 1) != 0
+            || ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            throw std::system_error(errno, std::generic_category(), "loopback listener");
+        }
+        const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (client < 0 || ::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            throw std::system_error(errno, std::generic_category(), "loopback connect");
+        }
+        const int server = ::accept(listener, nullptr, nullptr);
+        if (server < 0) {
+            throw std::system_error(errno, std::generic_category(), "loopback accept");
+        }
+
+        std::promise<std::string> tcp_data;
+        std::string tcp_buffer;
+        io_pool.WatchDescriptor(server, Reactor::EVENT_READ, [&](int fd, std::uint32_t events) {
+            char chunk[64];
+            const ssize_t count = (events & Reactor::EVENT_READ) ? ::read(fd, chunk, sizeof(chunk)) : 0;
+            if (count > 0) {
+                tcp_buffer.append(chunk, static_cast<std::size_t>(count));
+            }
+            else if (count == 0 || (events & Reactor::EVENT_ERROR)) {
+                io_pool.UnwatchDescriptor(fd);
+                tcp_data.set_value(tcp_buffer);
+            }
+        });
+        io_pool.WatchDescriptor(client, Reactor::EVENT_WRITE, [&](int fd, std::uint32_t events) {
+            if (events & Reactor::EVENT_WRITE) {
+                [[maybe_unused]] const ssize_t sent = ::write(fd, "hello over tcp", 14);
+            }
+            io_pool.UnwatchDescriptor(fd);
+            ::shutdown(fd, SHUT_WR);
+        });
+        cout << "tcp read: " << tcp_data.get_future().get() << '\n';
+        ::close(client);
+        ::close(server);
+        ::close(listener);
+
+        // Unwatching while the handler is still running: the descriptor
+        // stays readable, but the handler must not be called again.
+        if (::pipe(pipe_fds) != 0) {
+            throw std::system_error(errno, std::generic_category(), "pipe");
+        }
+        std::atomic<int> calls{ 0 };
+        std::promise<void> entered;
+        io_pool.WatchDescriptor(pipe_fds[0], Reactor::EVENT_READ, [&](int, std::uint32_t) {
+            if (calls.fetch_add(1) == 0) {
+                entered.set_value();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        });
+        [[maybe_unused]] const ssize_t poked = ::write(pipe_fds[1], "x", 1);
+        entered.get_future().get();
+        io_pool.UnwatchDescriptor(pipe_fds[0]);
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        cout << "handler calls after unwatch: " << calls.load() << '\n';
+        ::close(pipe_fds[0]);
+        ::close(pipe_fds[1]);
+    }
+
+    {
+        cout << "Test #IO1: -----------------\n";
+        // A task on a one-thread pool waits on its own reads: completions
+        // must be reaped without a free worker.
+        ThreadPool io_pool(1);
+        char path[] = "/tmp/threadpool-io1-XXXXXX";
+        const int file = ::mkstemp(path);
+        int pipe_fds[2];
+        if (file < 0 || ::pipe(pipe_fds) != 0) {
+            throw std::system_error(errno, std::generic_category(), "io demo");
+        }
+        ::unlink(path);
+        const std::string text = "read from a file";
+        io_pool.WriteAsync(file, std::as_bytes(std::span(text)), 0).get();
+
+        auto result = io_pool.AddSyncTask([&]() {
+            std::string from_file(text.size(), '\0');
+            const std::size_t file_size = io_pool.ReadAsync(file, std::as_writable_bytes(std::span(from_file)), 0).get();
+            [[maybe_unused]] const ssize_t written = ::write(pipe_fds[1], "and a pipe", 10);
+            std::string from_pipe(10, '\0');
+            const std::size_t pipe_size = io_pool.ReadAsync(pipe_fds[0], std::as_writable_bytes(std::span(from_pipe)), 0).get();
+            return from_file.substr(0, file_size) + ", " + from_pipe.substr(0, pipe_size);
+        });
+        cout << result.get() << '\n';
+        ::close(file);
+        ::close(pipe_fds[0]);
+        ::close(pipe_fds[1]);
+    }
+#endif
+
+    {
+        cout << "Test #B1: ------------------\n";
+        BasicPoolDemo<DequeQueue>("deque");
+        BasicPoolDemo<RingQueue<256>>("ring");
+        // A future outliving a PoolAlloc pool stays valid.
+        std::future<std::string> late;
+        {
+            BasicThreadPool<DequeQueue, CondVarWait, PoolAlloc> basic_pool(1);
+            late = basic_pool.AddSyncTask([] { return std::string("outlived the pool"); });
+        }
+        cout << late.get() << '\n';
+    }
+
+    {
+        cout << "Test #SH1: -----------------\n";
+        ShardedPool sharded(4);
+        // Targeted submissions land on their shard; work spawned there stays
+        // local, and a cross-shard hop goes through the shard mailbox. A
+        // shard never blocks on its own work, so results go to slots.
+        std::vector<std::size_t> ran(sharded.Shards()), local(sharded.Shards()), hop(sharded.Shards());
+        for (std::size_t shard = 0; shard < sharded.Shards(); ++shard) {
+            sharded.AddAsyncTaskTo(shard, [&, shard] {
+                ran[shard] = sharded.CurrentShard();
+                sharded.AddAsyncTask([&, shard] { local[shard] = sharded.CurrentShard(); });
+                sharded.AddAsyncTaskTo(shard + 1, [&, shard] { hop[shard] = sharded.CurrentShard(); });
+            });
+        }
+        sharded.Wait();
+        for (std::size_t shard = 0; shard < sharded.Shards(); ++shard) {
+            cout << "shard " << shard << ": ran on " << ran[shard] << ", local on " << local[shard] << ", hop to " << hop[shard] << '\n';
+        }
+        std::atomic<std::size_t> total{ 0 };
+        for (std::size_t z = 1; z <= 1000; ++z) {
+            sharded.AddAsyncTask([&total, z] { total.fetch_add(z); });
+        }
+        sharded.Wait();
+        cout << "round-robin sum: " << total.load() << '\n';
+    }
+
+    {
+        cout << "Test #D1: ------------------\n";
+        ThreadPool::Config config;
+        config.concurency = 1;
+        config.order_type = ThreadPool::OrderType::EDF;
+        ThreadPool edf_pool(config);
+        edf_pool.Pause();
+        const auto now = std::chrono::steady_clock::now();
+        std::vector<int> order;
+        std::vector<std::future<void>> results;
+        // Later deadlines are queued first; equal deadlines keep FIFO order
+        // and tasks without a deadline run last.
+        const int offsets[] = { 30, 20, 10, 20, 10 };
+        for (int z = 0; z < 5; ++z) {
+            results.push_back(edf_pool.AddSyncTask(now + std::chrono::seconds(offsets[z]), [&order, z] { order.push_back(z); }));
+        }
+        results.push_back(edf_pool.AddSyncTask([&order] { order.push_back(5); }));
+        auto expired = edf_pool.AddSyncTask(now - std::chrono::milliseconds(1), [] { return 0; });
+        edf_pool.Continue();
+        for (std::future<void>& result : results) {
+            result.get();
+        }
+        cout << "run order:";
+        for (const int z : order) {
+            cout << ' ' << z;
+        }
+        cout << '\n';
+        try {
+            expired.get();
+        }
+        catch (const std::system_error& error) {
+            cout << "expired task: " << (error.code() == std::errc::timed_out ? "timed_out" : error.what()) << '\n';
+        }
+        cout << "tasks expired: " << edf_pool.TasksExpired() << '\n';
+
+        // The deadline only guards the start: a loop task that passes it
+        // mid-way still runs every iteration.
+        int iterations{ 0 };
+        std::unique_ptr<Task> loop = std::make_unique<Task>();
+        loop->SetCondition([&iterations] { return iterations < 5; });
+        loop->SetLoopJob([&iterations] {
+            ++iterations;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        });
+        loop->SetDeadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(20));
+        edf_pool.AddAsyncTask(std::move(loop));
+        edf_pool.Wait();
+        cout << "loop past its deadline: " << iterations << " iterations, tasks expired: " << edf_pool.TasksExpired() << '\n';
+    }
+
+    {
+        cout << "Test #PA1: -----------------\n";
+        // Each par:: algorithm against its std:: counterpart, on ranges big
+        // enough to be split into blocks.
+        std::vector<int> input(300000);
+        for (int& value : input) {
+            value = RandomN(0, 1000);
+        }
+
+        std::vector<int> sorted = input;
+        std::vector<int> expected = input;
+        par::Sort(pool, sorted.begin(), sorted.end());
+        std::stable_sort(expected.begin(), expected.end());
+        cout << "Sort: " << (sorted == expected ? "ok" : "mismatch") << '\n';
+
+        std::vector<long long> scan(input.begin(), input.end());
+        std::vector<long long> expected_scan(input.size());
+        par::InclusiveScan(pool, scan.begin(), scan.end(), scan.begin());
+        std::inclusive_scan(input.begin(), input.end(), expected_scan.begin(), std::plus<long long>{});
+        cout << "InclusiveScan in place: " << (scan == expected_scan ? "ok" : "mismatch") << '\n';
+
+        scan.assign(input.begin(), input.end());
+        par::ExclusiveScan(pool, scan.begin(), scan.end(), scan.begin(), 7LL);
+        std::exclusive_scan(input.begin(), input.end(), expected_scan.begin(), 7LL, std::plus<long long>{});
+        cout << "ExclusiveScan in place: " << (scan == expected_scan ? "ok" : "mismatch") << '\n';
+
+        const auto square = [](const int value) { return static_cast<long long>(value) * value; };
+        const long long squares = par::TransformReduce(pool, input.begin(), input.end(), 0LL, std::plus<>{}, square);
+        const long long expected_squares = std::transform_reduce(input.begin(), input.end(), 0LL, std::plus<>{}, square);
+        const long long dot = par::TransformReduce(pool, input.begin(), input.end(), sorted.begin(), 0LL);
+        const long long expected_dot = std::inner_product(input.begin(), input.end(), sorted.begin(), 0LL);
+        cout << "TransformReduce: " << (squares == expected_squares ? "ok" : "mismatch")
+            << ", inner product: " << (dot == expected_dot ? "ok" : "mismatch") << '\n';
+
+        // From inside a task the blocks are split recursively on the pool.
+        auto on_pool = pool.AddSyncTask([&pool, &input, square] {
+            return par::TransformReduce(pool, input.begin(), input.end(), 0LL, std::plus<>{}, square);
+        });
+        cout << "TransformReduce on the pool: " << (on_pool.get() == expected_squares ? "ok" : "mismatch") << '\n';
+    }
+
+    {
+        cout << "Test #DR1: -----------------\n";
+        // Two backlogged channels on one worker: deficit round-robin hands
+        // "interactive" about three times the run time of "bulk".
+        ThreadPool drr_pool(1);
+        const ChannelId bulk = drr_pool.AddChannel("bulk", 1);
+        const ChannelId interactive = drr_pool.AddChannel("interactive", 3);
+        std::string order;
+        drr_pool.Pause();
+        for (int z = 0; z < 40; ++z) {
+            drr_pool.AddAsyncTask(bulk, [&order] {
+                order.push_back('b');
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            });
+            drr_pool.AddAsyncTask(interactive, [&order] {
+                order.push_back('i');
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            });
+        }
+        drr_pool.Continue();
+        drr_pool.Wait();
+        const std::string head = order.substr(0, 40);
+        cout << "first 40 runs: " << std::count(head.begin(), head.end(), 'i') << " interactive, " << std::count(head.begin(), head.end(), 'b') << " bulk\n";
+
+        // A paused channel keeps its backlog while the others go on.
+        drr_pool.PauseChannel(bulk);
+        std::atomic<int> bulk_ran{ 0 };
+        std::atomic<int> interactive_ran{ 0 };
+        for (int z = 0; z < 5; ++z) {
+            drr_pool.AddAsyncTask(bulk, [&bulk_ran] { ++bulk_ran; });
+            drr_pool.AddAsyncTask(drr_pool.FindChannel("interactive"), [&interactive_ran] { ++interactive_ran; });
+        }
+        while (interactive_ran < 5) {
+            std::this_thread::yield();
+        }
+        cout << "bulk paused: " << bulk_ran << " bulk, " << interactive_ran << " interactive\n";
+        drr_pool.ContinueChannel(bulk);
+        drr_pool.Wait();
+        cout << "bulk resumed: " << bulk_ran << " bulk\n";
+    }
+
+    {
+        cout << "Test #BA1: -----------------\n";
+        // Cheap tasks are dequeued in batches under one queue lock; FIFO
+        // order survives batching on a single worker.
+        ThreadPool batch_pool(1);
+        std::vector<int> seen;
+        seen.reserve(100000);
+        const auto started = std::chrono::steady_clock::now();
+        for (int z = 0; z < 100000; ++z) {
+            batch_pool.AddAsyncTask([&seen, z] { seen.push_back(z); });
+        }
+        batch_pool.Wait();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        cout << "100000 tiny tasks: " << (std::is_sorted(seen.begin(), seen.end()) && seen.size() == 100000 ? "in order" : "out of order") << ", " << elapsed.count() << " ms\n";
+
+        // Long tasks shrink the batch to one, so they still spread over
+        // every worker instead of piling up in one worker's buffer.
+        ThreadPool wide_pool(4);
+        std::mutex workers_mutex;
+        std::set<std::size_t> workers;
+        for (int z = 0; z < 16; ++z) {
+            wide_pool.AddAsyncTask([&workers_mutex, &workers] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                const std::scoped_lock workers_lock(workers_mutex);
+                workers.insert(ThreadPool::CurrentWorker()->Index());
+            });
+        }
+        wide_pool.Wait();
+        cout << "16 long tasks ran on " << workers.size() << " workers\n";
+
+        // A task waiting on the next one in the same batch: the idle worker
+        // takes the rest of the batch instead of leaving it stranded.
+        ThreadPool pair_pool(2);
+        for (int round = 0; round < 50; ++round) {
+            std::promise<void> ready;
+            std::shared_future<void> waited = ready.get_future().share();
+            for (int z = 0; z < 64; ++z) {
+                pair_pool.AddAsyncTask([] {});
+            }
+            pair_pool.AddAsyncTask([waited] { waited.wait(); });
+            pair_pool.AddAsyncTask([&ready] { ready.set_value(); });
+            for (int z = 0; z < 64; ++z) {
+                pair_pool.AddAsyncTask([] {});
+            }
+            pair_pool.Wait();
+        }
+        cout << "50 rounds of a waiter batched with its setter: done\n";
+    }
+
+    {
+        cout << "Test #EX1: -----------------\n";
+        CountingResource counting;
+        ThreadPool::Config config;
+        config.concurency = 2;
+        config.resource = &counting;
+        ThreadPool exec_pool(config);
+        const exec::PoolScheduler scheduler = exec_pool.GetScheduler();
+
+        auto answer = exec::sync_wait(exec::schedule(scheduler) | exec::then([] { return 21; }) | exec::then([](int value) { return value * 2; }));
+        cout << "schedule | then | then: " << std::get<0>(*answer) << '\n';
+
+        std::vector<long> squares(10000);
+        auto total = exec::sync_wait(exec::schedule(scheduler)
+            | exec::then([] { return 2L; })
+            | exec::bulk(squares.size(), [&squares](std::size_t index, long power) { squares[index] = power == 2 ? static_cast<long>(index * index) : 0; })
+            | exec::then([&squares](long) { return std::accumulate(squares.begin(), squares.end(), 0L); }));
+        cout << "bulk sum of squares: " << std::get<0>(*total) << '\n';
+
+        try {
+            exec::sync_wait(exec::schedule(scheduler) | exec::then([] { throw std::runtime_error("failed on the pool"); }));
+        }
+        catch (const std::runtime_error& error) {
+            cout << "error: " << error.what() << '\n';
+        }
+
+        // Operation states live on the caller's stack and are queued
+        // intrusively, so scheduling takes nothing from the pool's resource;
+        // AddSyncTask needs a Task and a promise per call.
+        std::size_t before = counting.Allocations();
+        for (int z = 0; z < 1000; ++z) {
+            exec::sync_wait(exec::schedule(scheduler) | exec::then([z] { return z; }));
+        }
+        cout << "pool allocations for 1000 senders: " << counting.Allocations() - before << '\n';
+        before = counting.Allocations();
+        for (int z = 0; z < 1000; ++z) {
+            exec_pool.AddSyncTask([z] { return z; }).get();
+        }
+        cout << "pool allocations for 1000 AddSyncTask: " << counting.Allocations() - before << '\n';
+    }
+
+    {
+        cout << "Test #MR1: -----------------\n";
+        // Every internal allocation of the pool goes to Config::resource:
+        // here a synchronized pool resource that recycles task blocks, over
+        // a counting upstream that shows what the pool really takes.
+        CountingResource upstream;
+        std::pmr::synchronized_pool_resource task_memory(&upstream);
+        {
+            ThreadPool::Config config;
+            config.concurency = 2;
+            config.resource = &task_memory;
+            ThreadPool pmr_pool(config);
+            const std::size_t started = upstream.Allocations();
+            for (int round = 0; round < 10; ++round) {
+                std::vector<std::future<std::size_t>> results;
+                for (int z = 0; z < 100; ++z) {
+                    results.push_back(pmr_pool.AddSyncTask(HardTest2, 100 + z));
+                }
+                for (std::future<std::size_t>& result : results) {
+                    result.get();
+                }
+            }
+            cout << "upstream allocations for 1000 tasks: " << upstream.Allocations() - started << '\n';
+            cout << "upstream bytes held: " << upstream.BytesInUse() / 1024 << " KiB\n";
+        }
+        task_memory.release();
+        cout << "upstream bytes after release: " << upstream.BytesInUse() << '\n';
+    }
+
+    {
+        cout << "Test #LZ1: -----------------\n";
+        // A lazy pool starts with no threads and adds one only when a
+        // submission finds every started worker busy, up to concurency.
+        ThreadPool::Config config;
+        config.concurency = 4;
+        config.start_type = ThreadPool::StartType::LAZY;
+        ThreadPool lazy_pool(config);
+        cout << "after construction: " << lazy_pool.ThreadsStarted() << " of " << lazy_pool.ThreadsCount() << " started\n";
+        lazy_pool.AddSyncTask([] {}).get();
+        lazy_pool.Wait();
+        cout << "after one quick task: " << lazy_pool.ThreadsStarted() << " started\n";
+        std::atomic_bool release{ false };
+        for (int z = 0; z < 8; ++z) {
+            lazy_pool.AddAsyncTask([&release] {
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        cout << "under a blocked backlog: " << lazy_pool.ThreadsStarted() << " started\n";
+        release = true;
+        lazy_pool.Wait();
+    }
+
+    {
+        cout << "Test #TG1: -----------------\n";
+        // One tag computes, the other mostly sleeps: TagReport shows the
+        // difference in cpu / wall. Untagged work is not accounted.
+        ThreadPool tag_pool(2);
+        const TaskTag compute("compute");
+        const TaskTag io(7);
+        for (int z = 0; z < 20; ++z) {
+            tag_pool.AddAsyncTask(compute, [] { HardTest2(3000); });
+            tag_pool.AddAsyncTask(io, [] { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+            tag_pool.AddAsyncTask([] { HardTest2(100); });
+        }
+        tag_pool.Wait();
+        for (const TagUsage& usage : tag_pool.TagReport()) {
+            const double ratio = usage.wall.count() > 0 ? static_cast<double>(usage.cpu.count()) / static_cast<double>(usage.wall.count()) : 0.0;
+            cout << "tag " << usage.tag.Name() << ": " << usage.count << " tasks, cpu/wall " << (ratio > 0.5 ? "high" : "low") << '\n';
+        }
+    }
+
+    {
+        cout << "Test #BU1: -----------------\n";
+        // Two four-thread pools share a budget of two running workers.
+        ConcurrencyBudget budget(2);
+        ThreadPool::Config config;
+        config.concurency = 4;
+        config.budget = &budget;
+        ThreadPool first_pool(config);
+        ThreadPool second_pool(config);
+
+        struct Peak {
+            std::atomic<int> running{ 0 };
+            std::atomic<int> peak{ 0 };
+            std::atomic<int> done{ 0 };
+        };
+        Peak total;
+        Peak first;
+        Peak second;
+        const auto load = [&total](ThreadPool& target, Peak& own) {
+            for (int z = 0; z < 24; ++z) {
+                target.AddAsyncTask([&total, &own] {
+                    for (Peak* peak : { &total, &own }) {
+                        const int now = ++peak->running;
+                        int seen = peak->peak.load();
+                        while (now > seen && !peak->peak.compare_exchange_weak(seen, now));
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    --own.running;
+                    --total.running;
+                    ++own.done;
+                });
+            }
+        };
+
+        // Alone, the first pool borrows the idle pool's share: both slots.
+        load(first_pool, first);
+        first_pool.Wait();
+        cout << "first pool alone: peak " << first.peak << " of " << first_pool.ThreadsCount() << " threads\n";
+
+        // Both busy: the cap holds across pools, and the second pool gets a
+        // slot back while the first still has a backlog.
+        first.done = 0;
+        total.peak = 0;
+        std::atomic<int> first_done_when_second_ran{ -1 };
+        load(first_pool, first);
+        second_pool.AddAsyncTask([&first, &first_done_when_second_ran] { first_done_when_second_ran = first.done.load(); });
+        load(second_pool, second);
+        first_pool.Wait();
+        second_pool.Wait();
+        cout << "both busy: peak " << total.peak << " across pools, second pool ran " << (first_done_when_second_ran < 24 ? "during" : "after") << " the first one's backlog\n";
+    }
+
 }
 
 class Test {
@@ -0,0 +1,242 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <unordered_map>
+
+#include <threadpool.hpp>
+#include <task_trace.hpp>
+
+// Rebuilds a workload captured with ThreadPool::StartRecording() from
+// synthetic tasks that spin for the recorded durations, then compares the
+// queueing delays of the replay with those of the recording.
+//
+// Usage: trace_replay <trace> [--threads N] [--lazy] [--stealing] [--out <trace>]
+//
+// Top-level tasks are submitted at their recorded times, one driver thread
+// per recorded submitting thread. Nested tasks are submitted by their
+// parent at the same offset into its run; LOOP tasks spread their run time
+// and nested submissions over the recorded number of iterations.
+
+using namespace vsock;
+using clock_type = std::chrono::steady_clock;
+using record_t = TaskTrace::Record;
+
+namespace {
+
+    void SpinUntil(const clock_type::time_point until) noexcept {
+        while (clock_type::now() < until) {
+        }
+    }
+
+    class Replay {
+    public:
+
+        Replay(const Replay&) = delete;
+        Replay& operator=(const Replay&) = delete;
+
+    public:
+
+        Replay(ThreadPool& pool, const TaskTrace& trace) :
+            pool_{ pool },
+            roots_{ },
+            children_{ },
+            start_{ }
+        {
+            std::unordered_map<std::uint64_t, const record_t*> known;
+            for (const record_t& record : trace.Records()) {
+                known.emplace(record.id, &record);
+            }
+            // Records come in submission order, so every list stays sorted.
+            for (const record_t& record : trace.Records()) {
+                if (record.parent != 0 && known.contains(record.parent)) {
+                    children_[record.parent].push_back(&record);
+                }
+                else {
+                    roots_[record.thread].push_back(&record);
+                }
+            }
+        }
+
+        void Run() {
+            start_ = clock_type::now() + std::chrono::milliseconds(10);
+            std::vector<std::thread> drivers;
+            for (const auto& [thread, roots] : roots_) {
+                drivers.emplace_back([this, &roots] {
+                    for (const record_t* record : roots) {
+                        std::this_thread::sleep_until(start_ + std::chrono::nanoseconds(record->submitted));
+                        Submit_(*record);
+                    }
+                });
+            }
+            for (std::thread& driver : drivers) {
+                driver.join();
+            }
+            pool_.Wait();
+        }
+
+    private:
+
+        ThreadPool& pool_;
+        std::unordered_map<std::uint32_t, std::vector<const record_t*>> roots_;
+        std::unordered_map<std::uint64_t, std::vector<const record_t*>> children_;
+        clock_type::time_point start_;
+
+        void Submit_(const record_t& record) {
+            if (record.iterations <= 1) {
+                pool_.AddAsyncTask([this, &record] {
+                    Execute_(record, 0, 1);
+                });
+                return;
+            }
+            std::unique_ptr<Task> task = std::make_unique<Task>();
+            task->vars.Add(std::uint32_t{ 0 });
+            task->SetCondition([&record](Task& task) -> bool {
+                return task.vars.Get<std::uint32_t>(0) < record.iterations;
+            }, std::ref(*task));
+            task->SetLoopJob([this, &record](Task& task) -> void {
+                std::uint32_t& iteration = task.vars.Get<std::uint32_t>(0);
+                Execute_(record, iteration, record.iterations);
+                ++iteration;
+            }, std::ref(*task));
+            pool_.AddAsyncTask(std::move(task));
+        }
+
+        // Spins through slice [from, to) of the recorded run, submitting the
+        // children that were submitted within it.
+        void Execute_(const record_t& record, const std::uint32_t slice, const std::uint32_t slices) {
+            const clock_type::time_point begin = clock_type::now();
+            const std::int64_t length = record.duration / slices;
+            const std::int64_t from = length * slice;
+            const bool last = slice + 1 == slices;
+            const std::int64_t to = last ? record.duration : from + length;
+            if (const auto found = children_.find(record.id); found != children_.end()) {
+                for (const record_t* child : found->second) {
+                    const std::int64_t offset = std::clamp<std::int64_t>(child->submitted - record.submitted - record.delay, 0, record.duration);
+                    if (offset < from || (offset >= to && !last)) {
+                        continue;
+                    }
+                    SpinUntil(begin + std::chrono::nanoseconds(offset - from));
+                    Submit_(*child);
+                }
+            }
+            SpinUntil(begin + std::chrono::nanoseconds(to - from));
+        }
+
+    };
+
+    struct Summary {
+        std::size_t tasks;
+        double makespan;
+        double busy;
+        double delay_p50;
+        double delay_p99;
+        double delay_max;
+    };
+
+    // Milliseconds for makespan and busy time, microseconds for delays.
+    Summary Summarize(const TaskTrace& trace) {
+        Summary summary{ trace.Size(), 0, 0, 0, 0, 0 };
+        if (trace.Empty()) {
+            return summary;
+        }
+        std::vector<std::int64_t> delays;
+        delays.reserve(trace.Size());
+        std::int64_t first = trace.Records().front().submitted;
+        std::int64_t finish{ 0 };
+        std::int64_t busy{ 0 };
+        for (const record_t& record : trace.Records()) {
+            first = std::min(first, record.submitted);
+            finish = std::max(finish, record.submitted + record.delay + record.duration);
+            busy += record.duration;
+            delays.push_back(record.delay);
+        }
+        std::sort(delays.begin(), delays.end());
+        const auto percentile = [&delays](const double rank) {
+            return static_cast<double>(delays[static_cast<std::size_t>(rank * static_cast<double>(delays.size() - 1))]) / 1e3;
+        };
+        summary.makespan = static_cast<double>(finish - first) / 1e6;
+        summary.busy = static_cast<double>(busy) / 1e6;
+        summary.delay_p50 = percentile(0.50);
+        summary.delay_p99 = percentile(0.99);
+        summary.delay_max = static_cast<double>(delays.back()) / 1e3;
+        return summary;
+    }
+
+    void Report(const std::string& name, const Summary& summary) {
+        std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << summary.tasks << std::setw(14) << summary.makespan << std::setw(12) << summary.busy
+            << std::setw(14) << summary.delay_p50 << std::setw(14) << summary.delay_p99 << std::setw(14) << summary.delay_max << '\n';
+    }
+
+    TaskTrace LoadTrace(const std::string& path) {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        return TaskTrace::Load(stream);
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <trace> [--threads N] [--lazy] [--stealing] [--out <trace>]\n";
+        return 2;
+    }
+    try {
+        const TaskTrace recorded = LoadTrace(argv[1]);
+        ThreadPool::Config config;
+        bool stealing{ false };
+        std::string out;
+        for (int arg = 2; arg < argc; ++arg) {
+            const std::string option = argv[arg];
+            if (option == "--threads" && arg + 1 < argc) {
+                config.concurency = std::stoul(argv[++arg]);
+            }
+            else if (option == "--lazy") {
+                config.start_type = ThreadPool::StartType::LAZY;
+            }
+            else if (option == "--stealing") {
+                stealing = true;
+            }
+            else if (option == "--out" && arg + 1 < argc) {
+                out = argv[++arg];
+            }
+            else {
+                throw std::runtime_error("unknown option " + option);
+            }
+        }
+
+        ThreadPool pool(config);
+        pool.SetWorkStealing(stealing);
+        Replay replay(pool, recorded);
+        pool.StartRecording();
+        replay.Run();
+        const TaskTrace replayed = pool.StopRecording();
+
+        std::cout << std::left << std::setw(10) << "" << std::right << std::setw(10) << "tasks" << std::setw(14) << "makespan ms"
+            << std::setw(12) << "busy ms" << std::setw(14) << "delay p50 us" << std::setw(14) << "delay p99 us" << std::setw(14) << "delay max us" << '\n';
+        Report("recorded", Summarize(recorded));
+        Report("replayed", Summarize(replayed));
+
+        if (!out.empty()) {
+            std::ofstream stream(out, std::ios::binary);
+            replayed.Save(stream);
+        }
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}